@@ -0,0 +1,50 @@
+#ifndef BINARYSEARCHTREE_BLOOMFILTER_H
+#define BINARYSEARCHTREE_BLOOMFILTER_H
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+/*
+** Blocked Bloom filter over 64-bit key hashes. Each key lives in one
+** 64-byte block, one bit in each of the block's eight words, so a lookup
+** reads a single cache line. A "no" is certain; a "yes" is wrong about
+** as often as falsePositiveRate() says. Keys can't be taken out: the
+** owner rebuilds the filter from its contents instead.
+*/
+namespace bloom
+{
+    const unsigned int BITS_PER_KEY = 10;
+
+    struct alignas(64) Block
+    {
+        std::uint64_t words[8];
+    };
+
+    class Filter
+    {
+
+    public:
+        Filter(void);
+        Filter(std::size_t expected);
+        ~Filter(void);
+
+    public:
+        void reset(std::size_t expected);
+        void add(std::uint64_t hash);
+        bool mayContain(std::uint64_t hash) const;
+        std::size_t keys(void) const;
+        std::size_t capacity(void) const;
+        std::size_t bytes(void) const;
+        double falsePositiveRate(void) const;
+
+    private:
+        std::size_t index(std::uint64_t hash) const;
+
+    private:
+        std::vector<Block> _blocks;
+        std::size_t _keys;
+    };
+}
+
+#endif //BINARYSEARCHTREE_BLOOMFILTER_H
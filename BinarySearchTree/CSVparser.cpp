@@ -2,56 +2,428 @@
 // Created by Alex Baires on 11/13/23.
 //
 
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <sstream>
 #include <iomanip>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+# define CSV_X86 1
+# include <immintrin.h>
+#else
+# define CSV_X86 0
+#endif
+// runtime AVX2 dispatch needs the GCC/Clang target attribute
+#if CSV_X86 && (defined(__GNUC__) || defined(__clang__))
+# define CSV_AVX2_DISPATCH 1
+#else
+# define CSV_AVX2_DISPATCH 0
+#endif
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+#ifndef _WIN32
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
 #include "CSVparser.h"
 
 namespace csv {
 
-    Parser::Parser(const std::string &data, const DataType &type, char sep)
-            : _type(type), _sep(sep)
+    /*
+    ** Reads the next non-blank line of text starting at pos, without its
+    ** line ending, and moves pos past it. Blank lines are skipped the same
+    ** way getline-based loading used to drop them.
+    */
+    static bool readLine(std::string_view text, std::size_t &pos, std::string_view &line)
     {
-        std::string line;
-        if (type == eFILE)
+        while (pos < text.size())
         {
-            _file = data;
-            std::ifstream ifile(_file.c_str());
-            if (ifile.is_open())
+            std::size_t start = pos;
+            std::size_t end = text.find('\n', start);
+            if (end == std::string_view::npos)
+                end = text.size();
+            pos = end + 1;
+
+            // files are read in binary, so drop the CR of CRLF endings here
+            if (end != start && text[end - 1] == '\r')
+                end--;
+
+            if (end != start)
             {
-                while (ifile.good())
-                {
-                    getline(ifile, line);
-                    if (line != "")
-                        _originalFile.push_back(line);
-                }
-                ifile.close();
+                line = text.substr(start, end - start);
+                return true;
+            }
+        }
+        pos = text.size();
+        return false;
+    }
+
+    /*
+    ** Strips the blanks the eBid exports leave around their column names.
+    */
+    static std::string trimName(const std::string &name)
+    {
+        std::size_t start = name.find_first_not_of(" \t");
+        if (start == std::string::npos)
+            return std::string();
+        std::size_t end = name.find_last_not_of(" \t");
+        return name.substr(start, end - start + 1);
+    }
+
+    /*
+    ** Number parsing for the typed Row accessors. Everything works on the
+    ** field bytes or a small stack buffer, never on a heap string.
+    */
+    static std::string_view trimField(std::string_view field)
+    {
+        std::size_t start = field.find_first_not_of(" \t");
+        if (start == std::string_view::npos)
+            return std::string_view();
+        std::size_t end = field.find_last_not_of(" \t");
+        field = field.substr(start, end - start + 1);
+
+        // quoted fields such as "$3,000 " keep their quotes after tokenizing
+        if (field.size() >= 2 && field.front() == '"' && field.back() == '"')
+            return trimField(field.substr(1, field.size() - 2));
+        return field;
+    }
+
+    static long long parseInteger(std::string_view field)
+    {
+        long long value = 0;
+
+        field = trimField(field);
+        if (field.empty())
+            return 0;
+        if (field[0] == '+')
+            field.remove_prefix(1);
+
+        std::from_chars_result res = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (res.ec != std::errc() || res.ptr != field.data() + field.size())
+            throw Error(std::string("can't convert this value to a number: ").append(field));
+        return value;
+    }
+
+    /*
+    ** Parses text that has already been stripped down to [-]digits[.digits].
+    ** Floating point from_chars is still missing from some standard
+    ** libraries, strtod on a stack copy stands in there.
+    */
+    static double parseNumber(const char *begin, const char *end, std::string_view field)
+    {
+        double value = 0.0;
+
+#if defined(__cpp_lib_to_chars)
+        std::from_chars_result res = std::from_chars(begin, end, value);
+        if (res.ec != std::errc() || res.ptr != end)
+            throw Error(std::string("can't convert this value to a number: ").append(field));
+#else
+        char buffer[64];
+        char *stop = nullptr;
+        std::size_t length = end - begin;
+
+        if (length >= sizeof(buffer))
+            throw Error(std::string("can't convert this value to a number: ").append(field));
+        std::memcpy(buffer, begin, length);
+        buffer[length] = '\0';
+        value = std::strtod(buffer, &stop);
+        if (stop != buffer + length)
+            throw Error(std::string("can't convert this value to a number: ").append(field));
+#endif
+        return value;
+    }
+
+    static double parseDouble(std::string_view field)
+    {
+        field = trimField(field);
+        if (field.empty())
+            return 0.0;
+        if (field[0] == '+')
+            field.remove_prefix(1);
+        return parseNumber(field.data(), field.data() + field.size(), field);
+    }
+
+    /*
+    ** Amounts such as "$3,000 " or "-$1.50": the dollar sign and thousands
+    ** separators are dropped while copying to a stack buffer.
+    */
+    static double parseCurrency(std::string_view field)
+    {
+        char buffer[64];
+        std::size_t length = 0;
+
+        field = trimField(field);
+        for (std::size_t i = 0; i < field.size(); i++)
+        {
+            char c = field[i];
+            if (c == '$' || c == ',' || c == '+')
+                continue;
+            if (length == sizeof(buffer))
+                throw Error(std::string("can't convert this value to a number: ").append(field));
+            buffer[length++] = c;
+        }
+
+        if (length == 0)
+            return 0.0;
+        return parseNumber(buffer, buffer + length, field);
+    }
+
+    /*
+    ** Splits a header line on sep the way getline would: an empty trailing
+    ** item is not kept.
+    */
+    static void splitHeader(std::string_view line, char sep, std::vector<std::string> &header)
+    {
+        std::size_t start = 0;
+
+        while (start < line.size())
+        {
+            std::size_t end = line.find(sep, start);
+            if (end == std::string_view::npos)
+                end = line.size();
+            header.push_back(std::string(line.substr(start, end - start)));
+            start = end + 1;
+        }
+    }
+
+    /*
+    ** SCAN KERNELS
+    **
+    ** Each kernel looks at one 32 byte block and returns a bitmask with bit
+    ** i set when byte i is the separator or a double quote. The tokenizer
+    ** then walks the set bits instead of testing every character.
+    */
 
-                if (_originalFile.size() == 0)
-                    throw Error(std::string("No Data in ").append(_file));
+    typedef std::uint32_t (*ScanFunction)(const char *, char);
 
-                parseHeader();
-                parseContent();
+    static std::uint32_t scanScalar(const char *block, char sep)
+    {
+        std::uint32_t mask = 0;
+
+        for (unsigned int i = 0; i < 32; i++)
+            if (block[i] == sep || block[i] == '"')
+                mask |= std::uint32_t(1) << i;
+        return mask;
+    }
+
+#if CSV_X86
+    static std::uint32_t scanSSE2(const char *block, char sep)
+    {
+        const __m128i seps = _mm_set1_epi8(sep);
+        const __m128i quotes = _mm_set1_epi8('"');
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16));
+
+        std::uint32_t maskLo = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(lo, seps),
+                                                              _mm_cmpeq_epi8(lo, quotes)));
+        std::uint32_t maskHi = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(hi, seps),
+                                                              _mm_cmpeq_epi8(hi, quotes)));
+        return (maskLo & 0xFFFF) | (maskHi << 16);
+    }
+
+# if CSV_AVX2_DISPATCH
+    __attribute__((target("avx2")))
+    static std::uint32_t scanAVX2(const char *block, char sep)
+    {
+        const __m256i seps = _mm256_set1_epi8(sep);
+        const __m256i quotes = _mm256_set1_epi8('"');
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+
+        return _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, seps),
+                                                    _mm256_cmpeq_epi8(bytes, quotes)));
+    }
+# endif
+#endif
+
+    static ScanKernel bestKernel(void)
+    {
+#if CSV_X86 && CSV_AVX2_DISPATCH
+        // this runs during static initialization, before cpu info is set up
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return eAVX2;
+#endif
+#if CSV_X86
+        return eSSE2;
+#else
+        return eSCALAR;
+#endif
+    }
+
+    static ScanKernel scanKernel = bestKernel();
+
+    static ScanFunction scanFunction(ScanKernel kernel)
+    {
+        switch (kernel)
+        {
+#if CSV_X86
+# if CSV_AVX2_DISPATCH
+            case eAVX2:
+                return scanAVX2;
+# endif
+            case eSSE2:
+                return scanSSE2;
+#endif
+            default:
+                return scanScalar;
+        }
+    }
+
+    static ScanFunction scan = scanFunction(scanKernel);
+
+    bool setScanKernel(ScanKernel kernel)
+    {
+        if (kernel > bestKernel())
+            return false;
+        scanKernel = kernel;
+        scan = scanFunction(kernel);
+        return true;
+    }
+
+    ScanKernel getScanKernel(void)
+    {
+        return scanKernel;
+    }
+
+    static inline unsigned int lowestBit(std::uint32_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long bit;
+        _BitScanForward(&bit, mask);
+        return bit;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    /*
+    ** Tokenizes one record into row. Separators inside double quotes are
+    ** part of the field. With borrow set the row only keeps views into line.
+    ** Columns the row's schema doesn't keep are skipped without a copy but
+    ** still counted, so the caller can check a projected line's width too.
+    ** Returns the number of columns in the line.
+    */
+    static unsigned int tokenize(std::string_view line, char sep, Row &row, bool borrow)
+    {
+        const ScanFunction kernel = scan;
+        const Schema &schema = row.schema();
+        const bool projected = schema.projected();
+        const char *data = line.data();
+        const std::size_t length = line.length();
+        bool quoted = false;
+        std::size_t tokenStart = 0;
+        unsigned int column = 0;
+        char tail[32];
+
+        for (std::size_t block = 0; block < length; block += 32)
+        {
+            std::uint32_t mask;
+
+            // the last partial block is padded with bytes that never match
+            if (length - block >= 32)
+                mask = kernel(data + block, sep);
+            else
+            {
+                std::memset(tail, sep == '\0' ? ' ' : '\0', sizeof(tail));
+                std::memcpy(tail, data + block, length - block);
+                mask = kernel(tail, sep);
+            }
+
+            while (mask != 0)
+            {
+                std::size_t i = block + lowestBit(mask);
+                mask &= mask - 1;
+
+                if (data[i] == '"')
+                    quoted = ((quoted) ? (false) : (true));
+                else if (!quoted)
+                {
+                    if (!projected || schema.slot(column) >= 0)
+                    {
+                        if (borrow)
+                            row.pushView(line.substr(tokenStart, i - tokenStart));
+                        else
+                            row.push(std::string(line.substr(tokenStart, i - tokenStart)));
+                    }
+                    tokenStart = i + 1;
+                    column++;
+                }
             }
+        }
+
+        //end
+        if (!projected || schema.slot(column) >= 0)
+        {
+            if (borrow)
+                row.pushView(line.substr(tokenStart));
             else
+                row.push(std::string(line.substr(tokenStart)));
+        }
+        return column + 1;
+    }
+
+    Parser::Parser(const std::string &data, const DataType &type, char sep, unsigned int threads)
+            : Parser(data, Projection(), type, sep, threads) {}
+
+    Parser::Parser(const std::string &data, const Projection &columns, const DataType &type, char sep,
+                   unsigned int threads)
+            : _type(type), _sep(sep), _threads(threads), _projection(columns), _journalBytes(0), _compactBytes(0)
+    {
+        if (type == eFILE)
+        {
+            _file = data;
+            std::ifstream ifile(_file.c_str(), std::ios::binary);
+            if (!ifile.is_open())
                 throw Error(std::string("Failed to open ").append(_file));
+
+            std::ostringstream ss;
+            ss << ifile.rdbuf();
+            _buffer = ss.str();
+            _data = _buffer;
+        }
+        else if (type == eMMAP)
+        {
+            // rows will point straight into the mapping, nothing is copied
+            _file = data;
+            _mapping.reset(new MappedFile(_file));
+            _data = std::string_view(_mapping->data(), _mapping->size());
         }
         else
         {
-            std::istringstream stream(data);
-            while (std::getline(stream, line))
-                if (line != "")
-                    _originalFile.push_back(line);
-            if (_originalFile.size() == 0)
-                throw Error(std::string("No Data in pure content"));
+            _buffer = data;
+            _data = _buffer;
+        }
 
-            parseHeader();
-            parseContent();
+        parseHeader();
+        parseContent();
+
+        // rows own copies of their fields unless they point into a mapping,
+        // so the text read into the buffer isn't needed any more
+        if (_type != eMMAP)
+        {
+            std::string().swap(_buffer);
+            _data = std::string_view();
+            _body = std::string_view();
         }
     }
 
     Parser::~Parser(void)
     {
+        // a compaction still writing in the background has to finish first
+        if (_compaction.valid())
+            _compaction.wait();
+
         std::vector<Row *>::iterator it;
 
         for (it = _content.begin(); it != _content.end(); it++)
@@ -60,49 +432,137 @@ namespace csv {
 
     void Parser::parseHeader(void)
     {
-        std::stringstream ss(_originalFile[0]);
-        std::string item;
+        std::string_view line;
+        std::size_t pos = 0;
 
-        while (std::getline(ss, item, _sep))
-            _header.push_back(item);
+        if (!readLine(_data, pos, line))
+        {
+            if (_type == ePURE)
+                throw Error(std::string("No Data in pure content"));
+            throw Error(std::string("No Data in ").append(_file));
+        }
+
+        splitHeader(line, _sep, _header);
+        if (_projection.empty())
+            _schema = std::make_shared<const Schema>(_header);
+        else
+            _schema = std::make_shared<const Schema>(_header, _projection.resolve(Schema(_header)));
+        _body = _data.substr(pos);
     }
 
+    /*
+    ** With more than one thread the body is cut into byte ranges that each
+    ** end just after a newline. A record never spans lines (quote state is
+    ** reset on every line), so those cuts always fall on record boundaries
+    ** and each range can be tokenized on its own. The ranges are parsed in
+    ** parallel and their rows appended in file order.
+    */
     void Parser::parseContent(void)
     {
-        std::vector<std::string>::iterator it;
+        unsigned int threads = _threads;
+
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        // not worth a thread for less than this much text
+        const std::size_t minChunk = 64 * 1024;
+        if (_body.size() / minChunk < threads)
+            threads = std::max<std::size_t>(1, _body.size() / minChunk);
 
-        it = _originalFile.begin();
-        it++; // skip header
+        if (threads == 1)
+        {
+            try
+            {
+                parseRange(_body, _schema, _content);
+            }
+            catch (...)
+            {
+                for (auto it = _content.begin(); it != _content.end(); it++)
+                    delete *it;
+                _content.clear();
+                throw;
+            }
+            return;
+        }
 
-        for (; it != _originalFile.end(); it++)
+        std::vector<std::string_view> chunks;
+        std::size_t start = 0;
+        for (unsigned int i = 1; i <= threads && start < _body.size(); i++)
         {
-            bool quoted = false;
-            int tokenStart = 0;
-            unsigned int i = 0;
+            std::size_t end = _body.size();
+            if (i < threads)
+            {
+                end = _body.find('\n', std::max(start, _body.size() * i / threads));
+                end = (end == std::string_view::npos) ? _body.size() : end + 1;
+            }
+            chunks.push_back(_body.substr(start, end - start));
+            start = end;
+        }
 
-            Row *row = new Row(_header);
+        // every worker's rows share the parser's one schema, as they do
+        // when a single thread parses
+        std::vector<std::vector<Row *>> parts(chunks.size());
+        std::vector<std::future<void>> workers;
+        for (std::size_t i = 0; i < chunks.size(); i++)
+            workers.push_back(std::async(std::launch::async, &Parser::parseRange, this, chunks[i], _schema,
+                                         std::ref(parts[i])));
 
-            for (; i != it->length(); i++)
+        // wait for every worker before touching their rows, even on error
+        std::exception_ptr error;
+        for (auto it = workers.begin(); it != workers.end(); it++)
+        {
+            try
             {
-                if (it->at(i) == '"')
-                    quoted = ((quoted) ? (false) : (true));
-                else if (it->at(i) == ',' && !quoted)
-                {
-                    row->push(it->substr(tokenStart, i - tokenStart));
-                    tokenStart = i + 1;
-                }
+                it->get();
+            }
+            catch (...)
+            {
+                if (!error)
+                    error = std::current_exception();
             }
+        }
 
-            //end
-            row->push(it->substr(tokenStart, it->length() - tokenStart));
+        std::size_t total = 0;
+        for (auto it = parts.begin(); it != parts.end(); it++)
+            total += it->size();
+        _content.reserve(total);
+        for (auto it = parts.begin(); it != parts.end(); it++)
+            _content.insert(_content.end(), it->begin(), it->end());
+
+        // the destructor won't run on a throwing constructor, so free them here
+        if (error)
+        {
+            for (auto it = _content.begin(); it != _content.end(); it++)
+                delete *it;
+            _content.clear();
+            std::rethrow_exception(error);
+        }
+    }
 
-            // if value(s) missing
-            if (row->size() != _header.size())
+    void Parser::parseRange(std::string_view text, std::shared_ptr<const Schema> schema,
+                            std::vector<Row *> &rows) const
+    {
+        std::string_view line;
+        std::size_t pos = 0;
+
+        while (readLine(text, pos, line))
+        {
+            Row *row = new Row(schema);
+
+            // if value(s) missing, or extra, whether or not they are kept
+            if (parseLine(line, *row) != schema->size())
+            {
+                delete row;
                 throw Error("corrupted data !");
-            _content.push_back(row);
+            }
+            rows.push_back(row);
         }
     }
 
+    unsigned int Parser::parseLine(std::string_view line, Row &row) const
+    {
+        return tokenize(line, _sep, row, _type == eMMAP);
+    }
+
     Row &Parser::getRow(unsigned int rowPosition) const
     {
         if (rowPosition < _content.size())
@@ -143,6 +603,8 @@ namespace csv {
         {
             delete *(_content.begin() + pos);
             _content.erase(_content.begin() + pos);
+            if (journaling())
+                appendJournal(std::string("-").append(std::to_string(pos)));
             return true;
         }
         return false;
@@ -150,42 +612,258 @@ namespace csv {
 
     bool Parser::addRow(unsigned int pos, const std::vector<std::string> &r)
     {
-        Row *row = new Row(_header);
+        if (pos > _content.size())
+            return false;
+
+        Row *row = new Row(_schema);
 
-        for (auto it = r.begin(); it != r.end(); it++)
-            row->push(*it);
+        // r is a whole line; a projected parser only keeps its columns
+        for (unsigned int i = 0; i < r.size(); i++)
+            if (_schema->slot(i) >= 0)
+                row->push(r[i]);
 
-        if (pos <= _content.size())
+        _content.insert(_content.begin() + pos, row);
+
+        if (journaling())
         {
-            _content.insert(_content.begin() + pos, row);
-            return true;
+            std::string entry = std::string("+").append(std::to_string(pos));
+            for (auto it = r.begin(); it != r.end(); it++)
+                entry.append(1, (it == r.begin()) ? ',' : _sep).append(*it);
+            appendJournal(entry);
         }
-        return false;
+        return true;
     }
 
     void Parser::sync(void) const
     {
-        if (_type == DataType::eFILE)
+        // every edit already went to the journal, the file itself is only
+        // rewritten by compaction
+        if (journaling())
         {
+            _journal.flush();
+            return;
+        }
+
+        // writing back would drop every column the projection skipped
+        if (_schema->projected())
+            throw Error("can't sync a projected file");
+
+        if (_type == DataType::eFILE || _type == DataType::eMMAP)
+        {
+            // A mapped file can't be truncated under its own rows, so write
+            // a sibling file and swap it in once it is complete.
+            std::string target = (_type == DataType::eMMAP) ? _file + ".tmp" : _file;
             std::ofstream f;
-            f.open(_file, std::ios::out | std::ios::trunc);
+            f.open(target, std::ios::out | std::ios::trunc);
+            f << serialize();
+            f.close();
 
-            // header
-            unsigned int i = 0;
-            for (auto it = _header.begin(); it != _header.end(); it++)
+            if (_type == DataType::eMMAP)
             {
-                f << *it;
-                if (i < _header.size() - 1)
-                    f << ",";
-                else
-                    f << std::endl;
-                i++;
+#ifdef _WIN32
+                std::remove(_file.c_str());
+#endif
+                if (std::rename(target.c_str(), _file.c_str()) != 0)
+                    throw Error(std::string("Failed to replace ").append(_file));
             }
+        }
+    }
 
-            for (auto it = _content.begin(); it != _content.end(); it++)
-                f << **it << std::endl;
-            f.close();
+    /*
+    ** The file exactly as sync() writes it: the header and every row, one
+    ** per line.
+    */
+    std::string Parser::serialize(void) const
+    {
+        std::ostringstream out;
+
+        for (unsigned int i = 0; i < _header.size(); i++)
+        {
+            out << _header[i];
+            out << ((i < _header.size() - 1) ? "," : "\n");
+        }
+
+        for (auto it = _content.begin(); it != _content.end(); it++)
+        {
+            const Row &row = **it;
+            for (unsigned int i = 0; i < row.size(); i++)
+            {
+                out << row.view(i);
+                if (i < row.size() - 1)
+                    out << ",";
+            }
+            out << "\n";
+        }
+        return out.str();
+    }
+
+    /*
+    ** FNV-1a over the serialized contents. A journal records the state it
+    ** applies on top of as "#base <rows> <bytes> <hash>", so a journal that
+    ** compaction already folded into the file is recognised and dropped.
+    */
+    static std::string journalBase(std::size_t rows, const std::string &text)
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+
+        for (std::size_t i = 0; i < text.size(); i++)
+        {
+            hash ^= static_cast<unsigned char>(text[i]);
+            hash *= 1099511628211ULL;
+        }
+        return std::string("#base ").append(std::to_string(rows)).append(" ")
+                .append(std::to_string(text.size())).append(" ").append(std::to_string(hash));
+    }
+
+    void Parser::enableJournal(void)
+    {
+        if (journaling())
+            return;
+        if (_type == DataType::ePURE)
+            throw Error("can't journal pure content (no file)");
+        if (_schema->projected())
+            throw Error("can't journal a projected file");
+
+        // A compaction that was cut short leaves the journal it was folding
+        // as .old; it comes before the current one.
+        std::string text = serialize();
+        bool replayed = replay(_file + ".journal.old", journalBase(_content.size(), text));
+        if (replayed)
+            text = serialize();
+        std::remove((_file + ".journal.old").c_str());
+        std::string base = journalBase(_content.size(), text);
+        if (replay(_file + ".journal", base))
+        {
+            replayed = true;
+            text = serialize();
         }
+
+        _compactBytes = std::max<std::size_t>(64 * 1024, text.size() / 2);
+        // rows replayed from an earlier run are folded in straight away
+        if (replayed)
+        {
+            compact();
+            return;
+        }
+        startJournal(base);
+    }
+
+    /*
+    ** Applies a journal on top of the rows if it was written against the
+    ** current state. Returns whether anything was applied.
+    */
+    bool Parser::replay(const std::string &path, const std::string &base)
+    {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        std::string line;
+
+        _journalBytes = 0;
+        if (!in.is_open() || !std::getline(in, line) || line != base)
+            return false;
+
+        while (std::getline(in, line))
+        {
+            if (line.empty())
+                continue;
+
+            std::size_t comma = line.find(',');
+            std::string number = line.substr(1, comma == std::string::npos ? std::string::npos : comma - 1);
+            unsigned int pos = 0;
+            std::from_chars_result res = std::from_chars(number.data(), number.data() + number.size(), pos);
+            if (res.ec != std::errc() || res.ptr != number.data() + number.size())
+                throw Error(std::string("corrupted journal ").append(path));
+
+            if (line[0] == '-' && pos < _content.size())
+            {
+                delete _content[pos];
+                _content.erase(_content.begin() + pos);
+            }
+            else if (line[0] == '+' && comma != std::string::npos && pos <= _content.size())
+            {
+                Row *row = new Row(_schema);
+                tokenize(std::string_view(line).substr(comma + 1), _sep, *row, false);
+                _content.insert(_content.begin() + pos, row);
+            }
+            else
+                throw Error(std::string("corrupted journal ").append(path));
+            _journalBytes += line.size() + 1;
+        }
+        return _journalBytes > 0;
+    }
+
+    void Parser::startJournal(const std::string &base)
+    {
+        std::string path = _file + ".journal";
+
+        _journal.close();
+        _journal.clear();
+        _journal.open(path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!_journal.is_open())
+            throw Error(std::string("Failed to open ").append(path));
+        _journal << base << "\n";
+        _journal.flush();
+        _journalBytes = 0;
+    }
+
+    void Parser::appendJournal(const std::string &entry)
+    {
+        _journal << entry << "\n";
+        _journal.flush();
+        _journalBytes += entry.size() + 1;
+
+        if (_journalBytes >= _compactBytes)
+            compact();
+    }
+
+    bool Parser::journaling(void) const
+    {
+        return _journal.is_open();
+    }
+
+    /*
+    ** Folds the journal into the file. The rows are serialized here, then
+    ** the journal is set aside as .old and a fresh one starts against the
+    ** new state, so edits can go on while a background task writes the
+    ** file. The file is replaced by rename only once it's complete.
+    */
+    void Parser::compact(void)
+    {
+        waitForCompaction();
+
+        std::string text = serialize();
+        std::string base = journalBase(_content.size(), text);
+        std::string journal = _file + ".journal";
+        std::string old = journal + ".old";
+        std::string target = _file + ".tmp";
+        std::string file = _file;
+
+        _journal.close();
+        std::rename(journal.c_str(), old.c_str());
+        startJournal(base);
+        _compactBytes = std::max<std::size_t>(64 * 1024, text.size() / 2);
+
+        _compaction = std::async(std::launch::async, [text, target, file, old]() {
+            std::ofstream f(target.c_str(), std::ios::binary | std::ios::trunc);
+            f << text;
+            f.close();
+            if (!f)
+                throw Error(std::string("Failed to write ").append(target));
+#ifdef _WIN32
+            std::remove(file.c_str());
+#endif
+            if (std::rename(target.c_str(), file.c_str()) != 0)
+                throw Error(std::string("Failed to replace ").append(file));
+            std::remove(old.c_str());
+        });
+    }
+
+    /*
+    ** Blocks until a background compaction is done and rethrows its error.
+    */
+    void Parser::waitForCompaction(void)
+    {
+        if (_compaction.valid())
+            _compaction.get();
     }
 
     const std::string &Parser::getFileName(void) const
@@ -193,18 +871,405 @@ namespace csv {
         return _file;
     }
 
+    ColumnHandle Parser::column(const std::string &name) const
+    {
+        return _schema->column(name);
+    }
+
+    ColumnHandle Parser::column(std::initializer_list<std::string> names) const
+    {
+        return _schema->column(names);
+    }
+
+    /*
+    ** READER
+    */
+
+    Reader::Reader(const std::string &file, char sep, std::size_t bufferSize)
+            : Reader(file, Projection(), sep, bufferSize) {}
+
+    Reader::Reader(const std::string &file, const Projection &columns, char sep, std::size_t bufferSize)
+            : _file(file), _sep(sep), _buffer(bufferSize ? bufferSize : 1), _begin(0), _end(0), _eof(false)
+    {
+        _stream.open(_file.c_str(), std::ios::binary);
+        if (!_stream.is_open())
+            throw Error(std::string("Failed to open ").append(_file));
+
+        std::string_view line;
+        if (!nextLine(line))
+            throw Error(std::string("No Data in ").append(_file));
+
+        splitHeader(line, _sep, _header);
+        _schema = std::make_shared<const Schema>(_header);
+        project(columns);
+    }
+
+    void Reader::project(const Projection &columns)
+    {
+        if (columns.empty())
+            _schema = std::make_shared<const Schema>(_header);
+        else
+            _schema = std::make_shared<const Schema>(_header, columns.resolve(*_schema));
+        _row.reset(new Row(_schema));
+    }
+
+    Reader::~Reader(void) {}
+
+    /*
+    ** Moves the unread tail to the front of the buffer and reads behind it.
+    ** The buffer only grows when a single line doesn't fit in it.
+    */
+    bool Reader::fill(void)
+    {
+        if (_eof)
+            return false;
+
+        std::size_t pending = _end - _begin;
+        if (pending > 0 && _begin > 0)
+            std::memmove(_buffer.data(), _buffer.data() + _begin, pending);
+        _begin = 0;
+        _end = pending;
+
+        if (_end == _buffer.size())
+            _buffer.resize(_buffer.size() * 2);
+
+        _stream.read(_buffer.data() + _end, _buffer.size() - _end);
+        std::streamsize got = _stream.gcount();
+        _end += got;
+        if (got == 0)
+            _eof = true;
+        return got > 0;
+    }
+
+    bool Reader::nextLine(std::string_view &line)
+    {
+        for (;;)
+        {
+            const char *start = _buffer.data() + _begin;
+            const char *nl = static_cast<const char *>(std::memchr(start, '\n', _end - _begin));
+            std::size_t length;
+
+            if (nl != nullptr)
+            {
+                length = nl - start;
+                _begin += length + 1;
+            }
+            else if (!fill())
+            {
+                // last line without a trailing newline
+                start = _buffer.data() + _begin;
+                length = _end - _begin;
+                _begin = _end;
+                if (length == 0)
+                    return false;
+            }
+            else
+                continue;
+
+            if (length > 0 && start[length - 1] == '\r')
+                length--;
+            // same as getline: blank lines are dropped
+            if (length == 0)
+                continue;
+
+            line = std::string_view(start, length);
+            return true;
+        }
+    }
+
+    bool Reader::next(void)
+    {
+        std::string_view line;
+
+        if (!nextLine(line))
+            return false;
+
+        _row->clear();
+
+        // if value(s) missing, or extra, whether or not they are kept
+        if (tokenize(line, _sep, *_row, true) != _schema->size())
+            throw Error("corrupted data !");
+        return true;
+    }
+
+    Reader::iterator Reader::begin(void)
+    {
+        if (next())
+            return iterator(this);
+        return end();
+    }
+
+    Reader::iterator Reader::end(void)
+    {
+        return iterator();
+    }
+
+    unsigned int Reader::columnCount(void) const
+    {
+        return _header.size();
+    }
+
+    std::vector<std::string> Reader::getHeader(void) const
+    {
+        return _header;
+    }
+
+    const std::string &Reader::getFileName(void) const
+    {
+        return _file;
+    }
+
+    ColumnHandle Reader::column(const std::string &name) const
+    {
+        return _schema->column(name);
+    }
+
+    ColumnHandle Reader::column(std::initializer_list<std::string> names) const
+    {
+        return _schema->column(names);
+    }
+
+    Reader::iterator::iterator(Reader *reader)
+            : _reader(reader) {}
+
+    const Row &Reader::iterator::operator*(void) const
+    {
+        return *_reader->_row;
+    }
+
+    const Row *Reader::iterator::operator->(void) const
+    {
+        return _reader->_row.get();
+    }
+
+    Reader::iterator &Reader::iterator::operator++(void)
+    {
+        if (!_reader->next())
+            _reader = nullptr;
+        return *this;
+    }
+
+    bool Reader::iterator::operator==(const iterator &other) const
+    {
+        return _reader == other._reader;
+    }
+
+    bool Reader::iterator::operator!=(const iterator &other) const
+    {
+        return _reader != other._reader;
+    }
+
+    /*
+    ** MAPPED FILE
+    */
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string &path)
+            : _data(nullptr), _size(0)
+    {
+        std::ifstream ifile(path.c_str(), std::ios::binary);
+        if (!ifile.is_open())
+            throw Error(std::string("Failed to open ").append(path));
+
+        std::ostringstream ss;
+        ss << ifile.rdbuf();
+        _buffer = ss.str();
+        _data = _buffer.data();
+        _size = _buffer.size();
+    }
+
+    MappedFile::~MappedFile(void) {}
+#else
+    MappedFile::MappedFile(const std::string &path)
+            : _data(nullptr), _size(0)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw Error(std::string("Failed to open ").append(path));
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw Error(std::string("Failed to stat ").append(path));
+        }
+
+        // mmap refuses zero-length mappings, an empty file is just no data
+        if (st.st_size > 0)
+        {
+            void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                close(fd);
+                throw Error(std::string("Failed to map ").append(path));
+            }
+            madvise(addr, st.st_size, MADV_SEQUENTIAL);
+            _data = static_cast<const char *>(addr);
+            _size = st.st_size;
+        }
+        close(fd);
+    }
+
+    MappedFile::~MappedFile(void)
+    {
+        if (_data != nullptr)
+            munmap(const_cast<char *>(_data), _size);
+    }
+#endif
+
+    const char *MappedFile::data(void) const
+    {
+        return _data;
+    }
+
+    std::size_t MappedFile::size(void) const
+    {
+        return _size;
+    }
+
+    /*
+    ** SCHEMA
+    */
+
+    Schema::Schema(const std::vector<std::string> &names)
+            : _names(names), _fieldCount(names.size())
+    {
+        // the first of two equally named columns wins, like a linear search
+        for (unsigned int i = 0; i < _names.size(); i++)
+            _index.emplace(trimName(_names[i]), i);
+    }
+
+    Schema::Schema(const std::vector<std::string> &names, const std::vector<unsigned int> &columns)
+            : Schema(names)
+    {
+        _slots.assign(_names.size(), -1);
+        _fieldCount = 0;
+        for (unsigned int i = 0; i < _names.size(); i++)
+            if (std::find(columns.begin(), columns.end(), i) != columns.end())
+                _slots[i] = _fieldCount++;
+    }
+
+    Schema::~Schema(void) {}
+
+    unsigned int Schema::size(void) const
+    {
+        return _names.size();
+    }
+
+    const std::vector<std::string> &Schema::names(void) const
+    {
+        return _names;
+    }
+
+    int Schema::indexOf(const std::string &name) const
+    {
+        auto it = _index.find(trimName(name));
+
+        if (it == _index.end())
+            return -1;
+        return it->second;
+    }
+
+    bool Schema::projected(void) const
+    {
+        return !_slots.empty();
+    }
+
+    unsigned int Schema::fieldCount(void) const
+    {
+        return _fieldCount;
+    }
+
+    /*
+    ** Where a column is stored in a row: the column itself without a
+    ** projection, -1 for a column the projection dropped.
+    */
+    int Schema::slot(unsigned int column) const
+    {
+        if (_slots.empty())
+            return column;
+        if (column >= _slots.size())
+            return -1;
+        return _slots[column];
+    }
+
+    ColumnHandle Schema::column(const std::string &name) const
+    {
+        int pos = indexOf(name);
+
+        if (pos < 0)
+            throw Error(std::string("can't find column ").append(name));
+        return ColumnHandle{static_cast<unsigned int>(pos)};
+    }
+
+    /*
+    ** Resolves the first of several names the same column goes by in
+    ** different exports.
+    */
+    ColumnHandle Schema::column(std::initializer_list<std::string> names) const
+    {
+        for (auto it = names.begin(); it != names.end(); it++)
+        {
+            int pos = indexOf(*it);
+            if (pos >= 0)
+                return ColumnHandle{static_cast<unsigned int>(pos)};
+        }
+        throw Error(std::string("can't find column ").append(names.size() ? *names.begin() : ""));
+    }
+
+    /*
+    ** PROJECTION
+    */
+
+    Projection::Projection(void) {}
+
+    Projection::Projection(std::initializer_list<unsigned int> positions)
+            : _positions(positions) {}
+
+    Projection::Projection(std::initializer_list<std::string> names)
+            : _names(names) {}
+
+    Projection::Projection(const std::vector<unsigned int> &positions)
+            : _positions(positions) {}
+
+    Projection::Projection(const std::vector<std::string> &names)
+            : _names(names) {}
+
+    bool Projection::empty(void) const
+    {
+        return _positions.empty() && _names.empty();
+    }
+
+    std::vector<unsigned int> Projection::resolve(const Schema &schema) const
+    {
+        std::vector<unsigned int> columns;
+
+        for (auto it = _positions.begin(); it != _positions.end(); it++)
+        {
+            if (*it >= schema.size())
+                throw Error("can't project this column (doesn't exist)");
+            columns.push_back(*it);
+        }
+        for (auto it = _names.begin(); it != _names.end(); it++)
+            columns.push_back(schema.column(*it).index);
+        return columns;
+    }
+
     /*
     ** ROW
     */
 
     Row::Row(const std::vector<std::string> &header)
-            : _header(header) {}
+            : _schema(std::make_shared<const Schema>(header)) {}
+
+    Row::Row(const std::shared_ptr<const Schema> &schema)
+            : _schema(schema) {}
 
     Row::~Row(void) {}
 
     unsigned int Row::size(void) const
     {
-        return _values.size();
+        return _values.size() + _views.size();
     }
 
     void Row::push(const std::string &value)
@@ -212,59 +1277,133 @@ namespace csv {
         _values.push_back(value);
     }
 
+    void Row::pushView(std::string_view value)
+    {
+        _views.push_back(value);
+    }
+
+    void Row::clear(void)
+    {
+        _values.clear();
+        _views.clear();
+    }
+
+    const Schema &Row::schema(void) const
+    {
+        return *_schema;
+    }
+
+    std::string_view Row::field(unsigned int slot) const
+    {
+        if (!_views.empty())
+            return _views[slot];
+        return _values[slot];
+    }
+
+    bool Row::has(unsigned int valuePosition) const
+    {
+        int slot = _schema->slot(valuePosition);
+        return slot >= 0 && static_cast<unsigned int>(slot) < size();
+    }
+
+    /*
+    ** Every accessor goes through here: a column missing from the row, or
+    ** left out by the projection, throws instead of indexing past the row.
+    */
+    std::string_view Row::view(unsigned int valuePosition) const
+    {
+        if (has(valuePosition))
+            return field(_schema->slot(valuePosition));
+        throw Error("can't return this value (doesn't exist)");
+    }
+
+    std::string_view Row::view(ColumnHandle column) const
+    {
+        return view(column.index);
+    }
+
     bool Row::set(const std::string &key, const std::string &value)
     {
-        std::vector<std::string>::const_iterator it;
-        int pos = 0;
+        int pos = _schema->indexOf(key);
+
+        if (pos < 0 || !has(pos))
+            return false;
 
-        for (it = _header.begin(); it != _header.end(); it++)
+        // a mapped row has to own its values before one can be replaced
+        if (!_views.empty())
         {
-            if (key == *it)
-            {
-                _values[pos] = value;
-                return true;
-            }
-            pos++;
+            for (auto v = _views.begin(); v != _views.end(); v++)
+                _values.push_back(std::string(*v));
+            _views.clear();
         }
-        return false;
+
+        _values[_schema->slot(pos)] = value;
+        return true;
     }
 
     const std::string Row::operator[](unsigned int valuePosition) const
     {
-        if (valuePosition < _values.size())
-            return _values[valuePosition];
-        throw Error("can't return this value (doesn't exist)");
+        return std::string(view(valuePosition));
     }
 
     const std::string Row::operator[](const std::string &key) const
     {
-        std::vector<std::string>::const_iterator it;
-        int pos = 0;
-
-        for (it = _header.begin(); it != _header.end(); it++)
-        {
-            if (key == *it)
-                return _values[pos];
-            pos++;
-        }
+        int pos = _schema->indexOf(key);
 
+        if (pos >= 0)
+            return std::string(view(pos));
         throw Error("can't return this value (doesn't exist)");
     }
 
+    const std::string Row::operator[](ColumnHandle column) const
+    {
+        return (*this)[column.index];
+    }
+
+    long long Row::getInteger(unsigned int pos) const
+    {
+        return parseInteger(view(pos));
+    }
+
+    long long Row::getInteger(ColumnHandle column) const
+    {
+        return getInteger(column.index);
+    }
+
+    double Row::getDouble(unsigned int pos) const
+    {
+        return parseDouble(view(pos));
+    }
+
+    double Row::getDouble(ColumnHandle column) const
+    {
+        return getDouble(column.index);
+    }
+
+    double Row::getCurrency(unsigned int pos) const
+    {
+        return parseCurrency(view(pos));
+    }
+
+    double Row::getCurrency(ColumnHandle column) const
+    {
+        return getCurrency(column.index);
+    }
+
     std::ostream &operator<<(std::ostream &os, const Row &row)
     {
-        for (unsigned int i = 0; i != row._values.size(); i++)
-            os << row._values[i] << " | ";
+        for (unsigned int i = 0; i != row.size(); i++)
+            os << row.field(i) << " | ";
 
         return os;
     }
 
     std::ofstream &operator<<(std::ofstream &os, const Row &row)
     {
-        for (unsigned int i = 0; i != row._values.size(); i++)
+        for (unsigned int i = 0; i != row.size(); i++)
         {
-            os << row._values[i];
-            if (i < row._values.size() - 1)
+            os << row.field(i);
+            if (i < row.size() - 1)
                 os << ",";
         }
         return os;
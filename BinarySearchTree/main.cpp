@@ -6,10 +6,20 @@
 // Description : Module 5: Binary Search Tree Assignment
 //============================================================================
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <string_view>
 #include <time.h>
+#include <vector>
 
+#include "BidSnapshot.h"
+#include "BloomFilter.h"
 #include "CSVparser.h"
+#include "NodePool.h"
 
 using namespace std;
 
@@ -17,9 +27,6 @@ using namespace std;
 // Global definitions visible to all methods and classes
 //============================================================================
 
-// forward declarations
-double strToDouble(string str, char ch);
-
 // define a structure to hold bid information
 struct Bid {
     string bidId; // unique identifier
@@ -37,15 +44,23 @@ struct Node {
     Node *left;
     Node *right;
 
+    // Levels in the subtree rooted here, 1 for a leaf
+    int height;
+
+    // Bids in the subtree rooted here, this one included
+    unsigned int size;
+
     // default constructor
     Node() {
         left = nullptr;
         right = nullptr;
+        height = 1;
+        size = 1;
     }
 
     // initialize with a given bid
     Node(Bid aBid) : Node() {
-        this->bid = aBid;
+        this->bid = std::move(aBid);
     }
 };
 
@@ -55,223 +70,1425 @@ struct Node {
 
 /**
  * Define a class containing data members and methods to
- * implement a binary search tree
+ * implement a binary search tree.
+ *
+ * A balanced tree (the default) is an AVL tree: every Insert and
+ * Remove rotates the nodes on its path so the two subtrees of any
+ * node differ in height by at most one, which keeps the tree
+ * O(log n) deep even when the bids arrive sorted by id, as the CSV
+ * exports do. An unbalanced tree keeps the plain insertion order
+ * shape and is there to compare against.
  */
 class BinarySearchTree {
 
 private:
     Node* root;
-
-    void addNode(Node* node, Bid bid);
+    bool balanced;
+
+    // Links followed by the last addNode or removeNode, root first
+    vector<Node**> path;
+
+    // Every node of the tree comes from here and goes back here
+    pool::NodePool<Node> nodePool;
+    unsigned int count = 0;
+
+    // Optional filter that answers most misses without walking the tree
+    bloom::Filter filter;
+    bool filtering = false;
+    unsigned int removedSinceBuild = 0;
+
+    void remember(uint64_t hashValue);
+    void rebuildFilter();
+    static int height(Node* node);
+    static unsigned int size(Node* node);
+    static void update(Node* node);
+    static Node* rotateLeft(Node* node);
+    static Node* rotateRight(Node* node);
+    Node* rebalance(Node* node);
+    void addNode(Bid &bid);
+    void forEach(Node* node, const function<void(const Bid &)> &visit);
     void inOrder(Node* node);
-    Node* removeNode(Node* node, string bidId);
+    bool removeNode(const string &bidId);
     void postOrder(Node* node);
     void preOrder(Node* node);
+    void visitFrom(const string &low, const function<bool(const Bid &)> &visit);
+    static void printBid(const Bid &bid);
 
 
 public:
     BinarySearchTree();
+    BinarySearchTree(bool balanced);
     virtual ~BinarySearchTree();
     void InOrder();
     void PostOrder();
     void PreOrder();
+    void ForEach(const function<void(const Bid &)> &visit);
+    void RangeQuery(const string &low, const string &high, const function<void(const Bid &)> &visit);
+    void PrefixQuery(const string &prefix, const function<void(const Bid &)> &visit);
+    Bid Select(unsigned int rank);
+    unsigned int Rank(const string &bidId);
+    vector<Bid> Page(unsigned int offset, unsigned int limit);
     void Insert(Bid bid);
     void Remove(string bidId);
     Bid Search(string bidId);
+    unsigned int Size() const;
+    unsigned int Height() const;
+    void EnableFilter();
+    void DisableFilter();
+    bool Filtering() const;
+    const bloom::Filter &GetFilter() const;
+    static uint64_t hashId(string_view bidId);
 };
 
-/**
- * Default constructor
- */
-BinarySearchTree::BinarySearchTree() {
-    // Initialize root as null pointer
-    root = nullptr;
+/**
+ * Default constructor
+ */
+BinarySearchTree::BinarySearchTree() : BinarySearchTree(true) {
+}
+
+/**
+ * Constructor choosing whether the tree balances itself
+ *
+ * @param balanced false for a plain binary search tree
+ */
+BinarySearchTree::BinarySearchTree(bool balanced) {
+    // Initialize root as null pointer
+    root = nullptr;
+    this->balanced = balanced;
+}
+
+/**
+ * Destructor
+ */
+BinarySearchTree::~BinarySearchTree() {
+    // The node pool releases every node in whole blocks
+}
+
+/**
+ * Traverse the tree in order
+ */
+void BinarySearchTree::InOrder() {
+    // Calls inOrder function with root as argument
+    this->inOrder(root);
+
+}
+
+/**
+ * Traverse the tree in post-order
+ */
+void BinarySearchTree::PostOrder() {
+    // Calls postOrder function with root as argument
+    this->postOrder(root);
+}
+
+/**
+ * Traverse the tree in pre-order
+ */
+void BinarySearchTree::PreOrder() {
+    // Calls preOrder function with root as argument
+    this->preOrder(root);
+}
+
+/**
+ * Visit every bid in pre-order. Re-inserting bids in this order rebuilds
+ * the same shape only in a plain tree; the AVL tree rotates as they go
+ * in, so a reloaded snapshot is balanced but not necessarily the same
+ * shape as the tree it was saved from.
+ *
+ * @param visit Function called with each bid
+ */
+void BinarySearchTree::ForEach(const function<void(const Bid &)> &visit) {
+    this->forEach(root, visit);
+}
+
+/**
+ * Visit, in id order, every bid with an id from low to high, both
+ * included. Only the path down to low and the bids in the range are
+ * touched, O(log n + k) nodes for k bids.
+ *
+ * @param low Smallest id to visit
+ * @param high Largest id to visit
+ * @param visit Function called with each bid in the range
+ */
+void BinarySearchTree::RangeQuery(const string &low, const string &high,
+                                  const function<void(const Bid &)> &visit) {
+    this->visitFrom(low, [&high, &visit](const Bid &bid) {
+        if (bid.bidId.compare(high) > 0) {
+            return false;
+        }
+        visit(bid);
+        return true;
+    });
+}
+
+/**
+ * Visit, in id order, every bid whose id starts with the prefix. The
+ * ids sharing a prefix sit next to each other in order, starting at
+ * the prefix itself, so this is a range query that stops at the first
+ * id without it.
+ *
+ * @param prefix Start of the ids to visit
+ * @param visit Function called with each matching bid
+ */
+void BinarySearchTree::PrefixQuery(const string &prefix, const function<void(const Bid &)> &visit) {
+    this->visitFrom(prefix, [&prefix, &visit](const Bid &bid) {
+        if (bid.bidId.compare(0, prefix.size(), prefix) != 0) {
+            return false;
+        }
+        visit(bid);
+        return true;
+    });
+}
+
+/**
+ * Find the bid at a position in id order, counting from 0. Each node
+ * knows the size of its left subtree, so the walk goes straight down
+ * to it, O(log n).
+ *
+ * @param rank Position of the bid in id order
+ * @return The bid, or an empty bid when rank is past the last one
+ */
+Bid BinarySearchTree::Select(unsigned int rank) {
+    Node* node = root;
+    while (node != nullptr) {
+        unsigned int leftSize = size(node->left);
+        if (rank < leftSize) {
+            node = node->left;
+        } else if (rank == leftSize) {
+            return node->bid;
+        } else {
+            rank -= leftSize + 1;
+            node = node->right;
+        }
+    }
+    return Bid();
+}
+
+/**
+ * Count the bids with an id below the given one, which is the
+ * position the id has, or would have, in id order. O(log n).
+ *
+ * @param bidId The id to rank, which need not be in the tree
+ */
+unsigned int BinarySearchTree::Rank(const string &bidId) {
+    unsigned int rank = 0;
+    Node* node = root;
+    while (node != nullptr) {
+        // The node and everything left of it come before the id
+        if (node->bid.bidId.compare(bidId) < 0) {
+            rank += size(node->left) + 1;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    return rank;
+}
+
+/**
+ * Get a page of bids in id order: up to limit bids starting at the
+ * one at position offset. The walk goes down to offset by subtree
+ * sizes and then steps in order, O(log n + limit), so a page deep
+ * into the tree costs no more than the first.
+ *
+ * @param offset Position of the page's first bid
+ * @param limit Most bids on the page
+ * @return The page's bids, fewer than limit at the end of the tree
+ */
+vector<Bid> BinarySearchTree::Page(unsigned int offset, unsigned int limit) {
+    vector<Bid> page;
+    vector<Node*> stack;
+    Node* node = root;
+
+    // Down to the bid at offset, keeping the nodes still to come
+    while (node != nullptr) {
+        unsigned int leftSize = size(node->left);
+        if (offset < leftSize) {
+            stack.push_back(node);
+            node = node->left;
+        } else if (offset == leftSize) {
+            stack.push_back(node);
+            break;
+        } else {
+            offset -= leftSize + 1;
+            node = node->right;
+        }
+    }
+
+    while (page.size() < limit && !stack.empty()) {
+        node = stack.back();
+        stack.pop_back();
+        page.push_back(node->bid);
+        for (node = node->right; node != nullptr; node = node->left) {
+            stack.push_back(node);
+        }
+    }
+    return page;
+}
+
+/**
+ * Insert a bid
+ */
+void BinarySearchTree::Insert(Bid bid) {
+    // The id is hashed before the bid is moved into its node
+    uint64_t hashValue = filtering ? hashId(bid.bidId) : 0;
+
+    // Call the add node function with the new bid
+    this->addNode(bid);
+    count++;
+    remember(hashValue);
+}
+
+/**
+ * Remove a bid
+ */
+void BinarySearchTree::Remove(string bidId) {
+    // remove the node with bidID, the root itself may be the one removed
+    bool removed = this->removeNode(bidId);
+
+    // The filter can't forget the id, it only costs false positives
+    // until enough have gone that a rebuild is worth it
+    if (filtering && removed && ++removedSinceBuild * 4 > count) {
+        rebuildFilter();
+    }
+}
+
+/**
+ * Search for a bid
+ */
+Bid BinarySearchTree::Search(string bidId) {
+    // A definite miss costs one cache line of the filter
+    if (filtering && !filter.mayContain(hashId(bidId))) {
+        return Bid();
+    }
+
+    // Sets current node equal to root
+    // Starts searching from the root
+    Node* current = root;
+
+    // Keeps looping downwards until bottom reached or matching bidId found
+    while (current != nullptr) {
+        // Base case: We found a matching bid
+        if (current->bid.bidId.compare(bidId) == 0) {
+            return current->bid;
+        }
+        // If bid is smaller than current node, then traverse left
+        if (bidId.compare(current->bid.bidId) < 0) {
+            current = current->left;
+        }
+        // Otherwise, the value is greater than the current node, Traverse right.
+        else {
+            current = current->right;
+        }
+    }
+
+    // Returns an empty bid because it was not found in left/right nodes
+    Bid bid;
+    return bid;
+}
+
+/**
+ * Returns the number of bids in the tree
+ */
+unsigned int BinarySearchTree::Size() const {
+    return count;
+}
+
+/**
+ * Returns the number of levels in the tree, 0 when it is empty
+ */
+unsigned int BinarySearchTree::Height() const {
+    return height(root);
+}
+
+/**
+ * Hashes a bid id for the filter. std::hash is only as wide as
+ * size_t, so its result is mixed out to 64 bits (the splitmix64
+ * finalizer); the filter uses both halves.
+ *
+ * @param bidId The bid id to hash
+ */
+uint64_t BinarySearchTree::hashId(string_view bidId) {
+    uint64_t x = hash<string_view>()(bidId);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Adds a new bid's hash to the filter, rebuilding the filter
+ * at twice the size once it holds as many keys as it was sized for.
+ *
+ * @param hashValue The hash of the new bid's id
+ */
+void BinarySearchTree::remember(uint64_t hashValue) {
+    if (!filtering) {
+        return;
+    }
+    if (filter.keys() >= filter.capacity()) {
+        rebuildFilter();
+    } else {
+        filter.add(hashValue);
+    }
+}
+
+/**
+ * Refills the filter from every bid in the tree, with room
+ * for the tree to double before it is rebuilt again.
+ */
+void BinarySearchTree::rebuildFilter() {
+    filter.reset(max(count * 2, 1024u));
+    removedSinceBuild = 0;
+    ForEach([this](const Bid &bid) {
+        filter.add(hashId(bid.bidId));
+    });
+}
+
+/**
+ * Puts a Bloom filter in front of Search, built from the bids
+ * already in the tree and kept up to date from then on.
+ */
+void BinarySearchTree::EnableFilter() {
+    filtering = true;
+    rebuildFilter();
+}
+
+/**
+ * Drops the filter, Search walks the tree for every id again
+ */
+void BinarySearchTree::DisableFilter() {
+    filtering = false;
+    filter.reset(0);
+}
+
+/**
+ * Returns whether Search goes through the filter
+ */
+bool BinarySearchTree::Filtering() const {
+    return filtering;
+}
+
+/**
+ * Returns the filter, for its size and false positive rate
+ */
+const bloom::Filter &BinarySearchTree::GetFilter() const {
+    return filter;
+}
+
+/**
+ * Returns the height of a subtree, 0 for an empty one
+ *
+ * @param node Root of the subtree
+ */
+int BinarySearchTree::height(Node* node) {
+    return (node == nullptr) ? 0 : node->height;
+}
+
+/**
+ * Returns the number of bids in a subtree, 0 for an empty one
+ *
+ * @param node Root of the subtree
+ */
+unsigned int BinarySearchTree::size(Node* node) {
+    return (node == nullptr) ? 0 : node->size;
+}
+
+/**
+ * Recomputes a node's height and size from its children
+ *
+ * @param node The node whose subtrees changed
+ */
+void BinarySearchTree::update(Node* node) {
+    node->height = 1 + max(height(node->left), height(node->right));
+    node->size = 1 + size(node->left) + size(node->right);
+}
+
+/**
+ * Rotates a node down to the left, its right child taking its place
+ *
+ * @param node Root of the subtree to rotate
+ * @return The new root of the subtree
+ */
+Node* BinarySearchTree::rotateLeft(Node* node) {
+    Node* child = node->right;
+    node->right = child->left;
+    child->left = node;
+    update(node);
+    update(child);
+    return child;
+}
+
+/**
+ * Rotates a node down to the right, its left child taking its place
+ *
+ * @param node Root of the subtree to rotate
+ * @return The new root of the subtree
+ */
+Node* BinarySearchTree::rotateRight(Node* node) {
+    Node* child = node->left;
+    node->left = child->right;
+    child->right = node;
+    update(node);
+    update(child);
+    return child;
+}
+
+/**
+ * Updates a node's height and size after one of its subtrees changed
+ * and, in a balanced tree, rotates it back within the AVL bound. An
+ * unbalanced tree only keeps the height and size.
+ *
+ * @param node Root of the subtree that changed
+ * @return The root of the subtree, which rotations may have changed
+ */
+Node* BinarySearchTree::rebalance(Node* node) {
+    update(node);
+    if (!balanced) {
+        return node;
+    }
+
+    int balance = height(node->left) - height(node->right);
+
+    // Left side too deep: a left-right shape is first turned left-left
+    if (balance > 1) {
+        if (height(node->left->left) < height(node->left->right)) {
+            node->left = rotateLeft(node->left);
+        }
+        return rotateRight(node);
+    }
+
+    // Right side too deep, the mirror image
+    if (balance < -1) {
+        if (height(node->right->right) < height(node->right->left)) {
+            node->right = rotateRight(node->right);
+        }
+        return rotateLeft(node);
+    }
+    return node;
+}
+
+/**
+ * Add a bid to the tree, moving it into a new node. The way down is
+ * kept on the path stack instead of the call stack, so a tree of any
+ * depth takes no recursion; the way back up rebalances each node on
+ * it and writes the result into the link that points at the node.
+ *
+ * @param bid Bid to be added
+ */
+void BinarySearchTree::addNode(Bid &bid) {
+    Node** link = &root;
+    path.clear();
+
+    // Walk down to the empty spot the new bid goes into
+    while (*link != nullptr) {
+        path.push_back(link);
+        // if node is larger than the bid, go down the left subtree
+        if ((*link)->bid.bidId.compare(bid.bidId) > 0) {
+            link = &(*link)->left;
+        }
+        // Otherwise down the right subtree
+        else {
+            link = &(*link)->right;
+        }
+    }
+    *link = nodePool.create(std::move(bid));
+
+    for (size_t i = path.size(); i > 0; i--) {
+        *path[i - 1] = rebalance(*path[i - 1]);
+    }
+}
+
+/**
+ * Remove the bid with the given id from the tree, without recursion.
+ * A node with two children takes the bid of its in-order successor,
+ * and the successor's node is the one unlinked.
+ *
+ * @param bidId Id of the bid to remove
+ * @return true when a bid was removed
+ */
+bool BinarySearchTree::removeNode(const string &bidId) {
+    Node** link = &root;
+    path.clear();
+
+    // Walk down to the node, or off the bottom of the tree
+    while (*link != nullptr && (*link)->bid.bidId.compare(bidId) != 0) {
+        path.push_back(link);
+        // Go down the left subtree (node bigger than bid)
+        if (bidId.compare((*link)->bid.bidId) < 0) {
+            link = &(*link)->left;
+        }
+        // Go down the right subtree (node smaller than bid)
+        else {
+            link = &(*link)->right;
+        }
+    }
+    if (*link == nullptr) {
+        return false;
+    }
+
+    Node* node = *link;
+    // Two children: the leftmost node of the right subtree comes out instead
+    if (node->left != nullptr && node->right != nullptr) {
+        path.push_back(link);
+        Node** successor = &node->right;
+        while ((*successor)->left != nullptr) {
+            path.push_back(successor);
+            successor = &(*successor)->left;
+        }
+        Node* temp = *successor;
+        node->bid = std::move(temp->bid);
+        *successor = temp->right;
+        nodePool.destroy(temp);
+    }
+    // No child or one child, which takes the node's place
+    else {
+        *link = (node->left != nullptr) ? node->left : node->right;
+        nodePool.destroy(node);
+    }
+    count--;
+
+    // Every node on the way back up may be out of balance now
+    for (size_t i = path.size(); i > 0; i--) {
+        *path[i - 1] = rebalance(*path[i - 1]);
+    }
+    return true;
+}
+
+/**
+ * Visits a subtree in pre-order, the nodes still to visit on an
+ * explicit stack, right child pushed under the left one
+ *
+ * @param node Root of the subtree
+ * @param visit Function called with each bid
+ */
+void BinarySearchTree::forEach(Node* node, const function<void(const Bid &)> &visit) {
+    vector<Node*> stack;
+    if (node != nullptr) {
+        stack.push_back(node);
+    }
+    while (!stack.empty()) {
+        node = stack.back();
+        stack.pop_back();
+        visit(node->bid);
+        if (node->right != nullptr) {
+            stack.push_back(node->right);
+        }
+        if (node->left != nullptr) {
+            stack.push_back(node->left);
+        }
+    }
+}
+
+/**
+ * Prints a subtree in order: down the left spine onto the stack,
+ * then each node popped is printed and its right subtree walked
+ *
+ * @param node Root of the subtree
+ */
+void BinarySearchTree::inOrder(Node* node) {
+    vector<Node*> stack;
+    while (node != nullptr || !stack.empty()) {
+        while (node != nullptr) {
+            stack.push_back(node);
+            node = node->left;
+        }
+        node = stack.back();
+        stack.pop_back();
+        printBid(node->bid);
+        node = node->right;
+    }
+}
+
+/**
+ * Visits bids in order starting at the first id not below low, until
+ * visit returns false. Left subtrees of nodes below low are never
+ * pushed, so the walk starts at low without passing the smaller ids.
+ *
+ * @param low Smallest id to visit
+ * @param visit Function called with each bid, false to stop
+ */
+void BinarySearchTree::visitFrom(const string &low, const function<bool(const Bid &)> &visit) {
+    vector<Node*> stack;
+    Node* node = root;
+    while (node != nullptr || !stack.empty()) {
+        while (node != nullptr) {
+            // Everything left of a node below low is below low too
+            if (node->bid.bidId.compare(low) < 0) {
+                node = node->right;
+            } else {
+                stack.push_back(node);
+                node = node->left;
+            }
+        }
+        if (stack.empty()) {
+            return;
+        }
+        node = stack.back();
+        stack.pop_back();
+        if (!visit(node->bid)) {
+            return;
+        }
+        node = node->right;
+    }
+}
+
+/**
+ * Prints a subtree in post-order. A node is printed once its right
+ * subtree is done, which is when the last node printed is its right
+ * child (or it has none).
+ *
+ * @param node Root of the subtree
+ */
+void BinarySearchTree::postOrder(Node* node) {
+    vector<Node*> stack;
+    Node* last = nullptr;
+    while (node != nullptr || !stack.empty()) {
+        while (node != nullptr) {
+            stack.push_back(node);
+            node = node->left;
+        }
+        Node* top = stack.back();
+        if (top->right != nullptr && top->right != last) {
+            node = top->right;
+        } else {
+            printBid(top->bid);
+            last = top;
+            stack.pop_back();
+        }
+    }
+}
+
+/**
+ * Prints a subtree in pre-order
+ *
+ * @param node Root of the subtree
+ */
+void BinarySearchTree::preOrder(Node* node) {
+    forEach(node, printBid);
+}
+
+/**
+ * Prints one bid of a traversal
+ *
+ * @param bid The bid to print
+ */
+void BinarySearchTree::printBid(const Bid &bid) {
+    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | " << bid.fund << endl;
+}
+
+//============================================================================
+// B+ tree index class definition
+//============================================================================
+
+/**
+ * Define a class containing data members and methods to
+ * implement a B+ tree index over bid ids.
+ *
+ * The nodes hold only keys and 32-bit indexes: the first 16 bytes
+ * of each id sit inline as two big-endian words, so comparing them
+ * is comparing the ids, and the bids themselves live apart in one
+ * array. A lookup goes down one node per level and binary searches
+ * a few cache lines in each, where the pointer tree takes a cache
+ * miss on every bid it compares. Leaves are linked left to right
+ * for in-order scans.
+ *
+ * Ids are unique: inserting an id already there keeps the first
+ * bid, the one Search would find. A node Remove leaves under half
+ * full borrows a key from a sibling or merges with it, and the
+ * nodes and bid slots it frees are reused by later inserts. Every
+ * separator is the first key under the child right of it, so the
+ * bid a separator names is always still in the tree.
+ */
+class BPlusTree {
+
+private:
+    // Keys per node before it splits. A node's keys span sixteen cache
+    // lines, prefetched together; 16, 32 and 128 measured slower.
+    static const unsigned int ORDER = 64;
+
+    // Fewest keys a node other than the root keeps, the size of the
+    // smaller half of a split
+    static const unsigned int MIN_KEYS = ORDER / 2 - 1;
+
+    static const uint32_t NONE = UINT32_MAX;
+
+    // The first 16 bytes of an id, zero padded, high word first
+    struct Key {
+        uint64_t high;
+        uint64_t low;
+    };
+
+    // Leaves hold up to ORDER - 1 keys, the last slot takes the
+    // key that makes them split
+    struct alignas(64) Leaf {
+        unsigned int count = 0;
+        uint32_t next = NONE;
+        Key keys[ORDER];
+        uint32_t bids[ORDER];
+    };
+
+    // Separator i is the smallest key under child i + 1; each keeps
+    // the bid it came from for ids longer than a key
+    struct alignas(64) Inner {
+        unsigned int count = 0;
+        Key keys[ORDER];
+        uint32_t bids[ORDER];
+        uint32_t children[ORDER + 1];
+    };
+
+    vector<Leaf> leaves;
+    vector<Inner> inners;
+    uint32_t root = 0;
+    unsigned int levels = 0;
+
+    // Nodes and bid slots Remove freed, taken before the arrays grow
+    vector<uint32_t> freeLeaves;
+    vector<uint32_t> freeInners;
+    vector<uint32_t> freeBids;
+
+    // Bids by index
+    vector<Bid> bids;
+    unsigned int count = 0;
+
+    // Inner nodes and child slots followed by the last Insert or
+    // Remove, root first
+    vector<pair<uint32_t, unsigned int>> path;
+
+    static Key makeKey(string_view bidId);
+    static void prefetchKeys(const Key* keys, unsigned int keyCount);
+    int compare(string_view bidId, const Key &key, const Key &other, uint32_t otherBid) const;
+    unsigned int upperBound(const Inner &inner, string_view bidId, const Key &key) const;
+    unsigned int lowerBound(const Leaf &leaf, string_view bidId, const Key &key) const;
+    uint32_t findLeaf(string_view bidId, const Key &key, bool recordPath);
+    uint32_t newLeaf();
+    uint32_t newInner();
+    void splitLeaf(uint32_t leaf);
+    void addSeparator(Key key, uint32_t bid, uint32_t child);
+    void rebalanceLeaf(uint32_t leaf);
+    void rebalanceInner(uint32_t inner);
+    void removeSeparator(unsigned int slot);
+
+public:
+    BPlusTree();
+    bool Insert(Bid bid);
+    bool Remove(string_view bidId);
+    const Bid* Find(string_view bidId) const;
+    Bid Search(string_view bidId) const;
+    void ForEach(const function<void(const Bid &)> &visit) const;
+    void RangeQuery(string_view low, string_view high, const function<void(const Bid &)> &visit) const;
+    unsigned int Size() const;
+    unsigned int Height() const;
+    size_t IndexBytes() const;
+};
+
+/**
+ * Default constructor, the tree starts as one empty leaf
+ */
+BPlusTree::BPlusTree() {
+    leaves.emplace_back();
+}
+
+/**
+ * Packs the first 16 bytes of an id into a key
+ *
+ * @param bidId The id to pack
+ */
+BPlusTree::Key BPlusTree::makeKey(string_view bidId) {
+    Key key = {0, 0};
+    for (size_t i = 0; i < 16; i++) {
+        uint64_t byte = (i < bidId.size()) ? static_cast<unsigned char>(bidId[i]) : 0;
+        if (i < 8) {
+            key.high = (key.high << 8) | byte;
+        } else {
+            key.low = (key.low << 8) | byte;
+        }
+    }
+    return key;
+}
+
+/**
+ * Asks the CPU to start loading every cache line of a node's keys, so
+ * the binary search over them waits for memory once instead of once
+ * per line it probes
+ *
+ * @param keys The node's keys
+ * @param keyCount How many of them are in use
+ */
+void BPlusTree::prefetchKeys(const Key* keys, unsigned int keyCount) {
+#if defined(__GNUC__) || defined(__clang__)
+    const char* bytes = reinterpret_cast<const char *>(keys);
+    for (size_t offset = 0; offset < keyCount * sizeof(Key); offset += 64) {
+        __builtin_prefetch(bytes + offset);
+    }
+#else
+    (void) keys;
+    (void) keyCount;
+#endif
+}
+
+/**
+ * Orders an id against a key in a node. Ids never hold a zero byte,
+ * so equal keys mean equal ids unless the id fills the whole key;
+ * only then is the other id read from its bid.
+ *
+ * @param bidId The id being looked for
+ * @param key The id's key
+ * @param other The key in the node
+ * @param otherBid The bid the key in the node came from
+ * @return Less than, equal to or greater than 0, as the id is below, at or above the other
+ */
+int BPlusTree::compare(string_view bidId, const Key &key, const Key &other, uint32_t otherBid) const {
+    if (key.high != other.high) {
+        return (key.high < other.high) ? -1 : 1;
+    }
+    if (key.low != other.low) {
+        return (key.low < other.low) ? -1 : 1;
+    }
+    if (bidId.size() < 16) {
+        return 0;
+    }
+    return bidId.compare(bids[otherBid].bidId);
+}
+
+/**
+ * @return The child of an inner node the id belongs under
+ */
+unsigned int BPlusTree::upperBound(const Inner &inner, string_view bidId, const Key &key) const {
+    unsigned int low = 0;
+    unsigned int high = inner.count;
+    while (low < high) {
+        unsigned int middle = (low + high) / 2;
+        if (compare(bidId, key, inner.keys[middle], inner.bids[middle]) >= 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * @return The slot of a leaf holding the id or where it would go
+ */
+unsigned int BPlusTree::lowerBound(const Leaf &leaf, string_view bidId, const Key &key) const {
+    unsigned int low = 0;
+    unsigned int high = leaf.count;
+    while (low < high) {
+        unsigned int middle = (low + high) / 2;
+        if (compare(bidId, key, leaf.keys[middle], leaf.bids[middle]) > 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * Walks down from the root to the leaf an id belongs in
+ *
+ * @param bidId The id to look for
+ * @param key The id's key
+ * @param recordPath Whether to keep the way down for a split or merge
+ * @return The leaf's index
+ */
+uint32_t BPlusTree::findLeaf(string_view bidId, const Key &key, bool recordPath) {
+    uint32_t node = root;
+    if (recordPath) {
+        path.clear();
+    }
+    for (unsigned int level = 0; level < levels; level++) {
+        const Inner &inner = inners[node];
+        unsigned int slot = upperBound(inner, bidId, key);
+        if (recordPath) {
+            path.push_back({node, slot});
+        }
+        node = inner.children[slot];
+    }
+    return node;
+}
+
+/**
+ * @return The index of an empty leaf, one Remove freed if there is one
+ */
+uint32_t BPlusTree::newLeaf() {
+    if (freeLeaves.empty()) {
+        leaves.emplace_back();
+        return leaves.size() - 1;
+    }
+    uint32_t leaf = freeLeaves.back();
+    freeLeaves.pop_back();
+    leaves[leaf].count = 0;
+    leaves[leaf].next = NONE;
+    return leaf;
+}
+
+/**
+ * @return The index of an empty inner node, one Remove freed if there is one
+ */
+uint32_t BPlusTree::newInner() {
+    if (freeInners.empty()) {
+        inners.emplace_back();
+        return inners.size() - 1;
+    }
+    uint32_t inner = freeInners.back();
+    freeInners.pop_back();
+    inners[inner].count = 0;
+    return inner;
+}
+
+/**
+ * Insert a bid, moving it into the bid array
+ *
+ * @param bid The bid to insert
+ * @return false when a bid with the same id was already there
+ */
+bool BPlusTree::Insert(Bid bid) {
+    Key key = makeKey(bid.bidId);
+    uint32_t leafIndex = findLeaf(bid.bidId, key, true);
+    Leaf &leaf = leaves[leafIndex];
+    unsigned int slot = lowerBound(leaf, bid.bidId, key);
+    if (slot < leaf.count && compare(bid.bidId, key, leaf.keys[slot], leaf.bids[slot]) == 0) {
+        return false;
+    }
+
+    uint32_t bidIndex;
+    if (freeBids.empty()) {
+        bidIndex = bids.size();
+        bids.push_back(std::move(bid));
+    } else {
+        bidIndex = freeBids.back();
+        freeBids.pop_back();
+        bids[bidIndex] = std::move(bid);
+    }
+
+    for (unsigned int i = leaf.count; i > slot; i--) {
+        leaf.keys[i] = leaf.keys[i - 1];
+        leaf.bids[i] = leaf.bids[i - 1];
+    }
+    leaf.keys[slot] = key;
+    leaf.bids[slot] = bidIndex;
+    leaf.count++;
+    count++;
+
+    if (leaf.count == ORDER) {
+        splitLeaf(leafIndex);
+    }
+    return true;
+}
+
+/**
+ * Moves the upper half of a full leaf into a new leaf linked after
+ * it, and adds the new leaf's first key to the parent
+ *
+ * @param leafIndex The full leaf
+ */
+void BPlusTree::splitLeaf(uint32_t leafIndex) {
+    // The new leaf may move the array, so the old one is found again after
+    uint32_t rightIndex = newLeaf();
+    Leaf &left = leaves[leafIndex];
+    Leaf &right = leaves[rightIndex];
+
+    unsigned int half = ORDER / 2;
+    for (unsigned int i = half; i < left.count; i++) {
+        right.keys[i - half] = left.keys[i];
+        right.bids[i - half] = left.bids[i];
+    }
+    right.count = left.count - half;
+    left.count = half;
+    right.next = left.next;
+    left.next = rightIndex;
+
+    addSeparator(right.keys[0], right.bids[0], rightIndex);
+}
+
+/**
+ * Adds a separator and the child to its right to the inner node at
+ * the end of the path, splitting full inner nodes up the path and
+ * growing a new root when the old one splits
+ *
+ * @param key The separator, the smallest key under child
+ * @param bid The bid the separator came from
+ * @param child The new node right of the separator
+ */
+void BPlusTree::addSeparator(Key key, uint32_t bid, uint32_t child) {
+    while (!path.empty()) {
+        uint32_t innerIndex = path.back().first;
+        unsigned int slot = path.back().second;
+        path.pop_back();
+
+        Inner &inner = inners[innerIndex];
+        for (unsigned int i = inner.count; i > slot; i--) {
+            inner.keys[i] = inner.keys[i - 1];
+            inner.bids[i] = inner.bids[i - 1];
+            inner.children[i + 1] = inner.children[i];
+        }
+        inner.keys[slot] = key;
+        inner.bids[slot] = bid;
+        inner.children[slot + 1] = child;
+        inner.count++;
+        if (inner.count < ORDER) {
+            return;
+        }
+
+        // The middle separator moves up, the keys right of it go to a new node
+        uint32_t rightIndex = newInner();
+        Inner &left = inners[innerIndex];
+        Inner &right = inners[rightIndex];
+        unsigned int middle = ORDER / 2;
+        for (unsigned int i = middle + 1; i < left.count; i++) {
+            right.keys[i - middle - 1] = left.keys[i];
+            right.bids[i - middle - 1] = left.bids[i];
+        }
+        for (unsigned int i = middle + 1; i <= left.count; i++) {
+            right.children[i - middle - 1] = left.children[i];
+        }
+        right.count = left.count - middle - 1;
+        left.count = middle;
+
+        key = left.keys[middle];
+        bid = left.bids[middle];
+        child = rightIndex;
+    }
+
+    // The root split, a new root goes above it
+    uint32_t top = newInner();
+    Inner &inner = inners[top];
+    inner.count = 1;
+    inner.keys[0] = key;
+    inner.bids[0] = bid;
+    inner.children[0] = root;
+    inner.children[1] = child;
+    root = top;
+    levels++;
 }
 
 /**
- * Destructor
+ * Remove a bid
+ *
+ * @param bidId The id of the bid to remove
+ * @return true when a bid was removed
  */
-BinarySearchTree::~BinarySearchTree() {
-    // recurse from root deleting every node
+bool BPlusTree::Remove(string_view bidId) {
+    Key key = makeKey(bidId);
+    uint32_t leafIndex = findLeaf(bidId, key, true);
+    Leaf &leaf = leaves[leafIndex];
+    unsigned int slot = lowerBound(leaf, bidId, key);
+    if (slot == leaf.count || compare(bidId, key, leaf.keys[slot], leaf.bids[slot]) != 0) {
+        return false;
+    }
+
+    uint32_t bidIndex = leaf.bids[slot];
+    for (unsigned int i = slot + 1; i < leaf.count; i++) {
+        leaf.keys[i - 1] = leaf.keys[i];
+        leaf.bids[i - 1] = leaf.bids[i];
+    }
+    leaf.count--;
+    count--;
+
+    // A leaf's first key is also the separator in the lowest ancestor
+    // the leaf isn't leftmost under, which takes the new first key
+    if (slot == 0 && leaf.count > 0) {
+        for (size_t level = path.size(); level > 0; level--) {
+            unsigned int child = path[level - 1].second;
+            if (child > 0) {
+                Inner &inner = inners[path[level - 1].first];
+                inner.keys[child - 1] = leaf.keys[0];
+                inner.bids[child - 1] = leaf.bids[0];
+                break;
+            }
+        }
+    }
+
+    // No separator names the bid any more, so its slot can be reused
+    bids[bidIndex] = Bid();
+    freeBids.push_back(bidIndex);
+
+    if (leaf.count < MIN_KEYS && !path.empty()) {
+        rebalanceLeaf(leafIndex);
+    }
+    return true;
 }
 
 /**
- * Traverse the tree in order
+ * Refills a leaf that fell under MIN_KEYS with a key from a sibling
+ * that can spare one, or else merges it with a sibling and takes the
+ * separator between them out of the parent
+ *
+ * @param leafIndex The leaf, the child at the end of the path
  */
-void BinarySearchTree::InOrder() {
-    // Calls inOrder function with root as argument
-    this->inOrder(root);
+void BPlusTree::rebalanceLeaf(uint32_t leafIndex) {
+    Inner &parent = inners[path.back().first];
+    unsigned int child = path.back().second;
+    Leaf &leaf = leaves[leafIndex];
+
+    if (child > 0) {
+        Leaf &left = leaves[parent.children[child - 1]];
+        if (left.count > MIN_KEYS) {
+            for (unsigned int i = leaf.count; i > 0; i--) {
+                leaf.keys[i] = leaf.keys[i - 1];
+                leaf.bids[i] = leaf.bids[i - 1];
+            }
+            left.count--;
+            leaf.keys[0] = left.keys[left.count];
+            leaf.bids[0] = left.bids[left.count];
+            leaf.count++;
+            parent.keys[child - 1] = leaf.keys[0];
+            parent.bids[child - 1] = leaf.bids[0];
+            return;
+        }
+    }
+    if (child < parent.count) {
+        Leaf &right = leaves[parent.children[child + 1]];
+        if (right.count > MIN_KEYS) {
+            leaf.keys[leaf.count] = right.keys[0];
+            leaf.bids[leaf.count] = right.bids[0];
+            leaf.count++;
+            for (unsigned int i = 1; i < right.count; i++) {
+                right.keys[i - 1] = right.keys[i];
+                right.bids[i - 1] = right.bids[i];
+            }
+            right.count--;
+            parent.keys[child] = right.keys[0];
+            parent.bids[child] = right.bids[0];
+            return;
+        }
+    }
 
+    // Neither sibling can spare a key, the right leaf of a pair empties into the left
+    unsigned int separator = (child > 0) ? child - 1 : 0;
+    uint32_t leftIndex = parent.children[separator];
+    uint32_t rightIndex = parent.children[separator + 1];
+    Leaf &left = leaves[leftIndex];
+    Leaf &right = leaves[rightIndex];
+    for (unsigned int i = 0; i < right.count; i++) {
+        left.keys[left.count + i] = right.keys[i];
+        left.bids[left.count + i] = right.bids[i];
+    }
+    left.count += right.count;
+    left.next = right.next;
+    freeLeaves.push_back(rightIndex);
+
+    removeSeparator(separator);
 }
 
 /**
- * Traverse the tree in post-order
+ * Refills an inner node that fell under MIN_KEYS by rotating a child
+ * over from a sibling through the parent, or else merges it with a
+ * sibling, pulling the separator between them down from the parent
+ *
+ * @param innerIndex The inner node, the child at the end of the path
  */
-void BinarySearchTree::PostOrder() {
-    // Calls postOrder function with root as argument
-    this->postOrder(root);
+void BPlusTree::rebalanceInner(uint32_t innerIndex) {
+    Inner &parent = inners[path.back().first];
+    unsigned int child = path.back().second;
+    Inner &inner = inners[innerIndex];
+
+    if (child > 0) {
+        Inner &left = inners[parent.children[child - 1]];
+        if (left.count > MIN_KEYS) {
+            for (unsigned int i = inner.count; i > 0; i--) {
+                inner.keys[i] = inner.keys[i - 1];
+                inner.bids[i] = inner.bids[i - 1];
+            }
+            for (unsigned int i = inner.count + 1; i > 0; i--) {
+                inner.children[i] = inner.children[i - 1];
+            }
+            inner.keys[0] = parent.keys[child - 1];
+            inner.bids[0] = parent.bids[child - 1];
+            inner.children[0] = left.children[left.count];
+            inner.count++;
+            left.count--;
+            parent.keys[child - 1] = left.keys[left.count];
+            parent.bids[child - 1] = left.bids[left.count];
+            return;
+        }
+    }
+    if (child < parent.count) {
+        Inner &right = inners[parent.children[child + 1]];
+        if (right.count > MIN_KEYS) {
+            inner.keys[inner.count] = parent.keys[child];
+            inner.bids[inner.count] = parent.bids[child];
+            inner.children[inner.count + 1] = right.children[0];
+            inner.count++;
+            parent.keys[child] = right.keys[0];
+            parent.bids[child] = right.bids[0];
+            for (unsigned int i = 1; i < right.count; i++) {
+                right.keys[i - 1] = right.keys[i];
+                right.bids[i - 1] = right.bids[i];
+            }
+            for (unsigned int i = 1; i <= right.count; i++) {
+                right.children[i - 1] = right.children[i];
+            }
+            right.count--;
+            return;
+        }
+    }
+
+    // The separator comes down between the left node's keys and the right one's
+    unsigned int separator = (child > 0) ? child - 1 : 0;
+    uint32_t rightIndex = parent.children[separator + 1];
+    Inner &left = inners[parent.children[separator]];
+    Inner &right = inners[rightIndex];
+    left.keys[left.count] = parent.keys[separator];
+    left.bids[left.count] = parent.bids[separator];
+    for (unsigned int i = 0; i < right.count; i++) {
+        left.keys[left.count + 1 + i] = right.keys[i];
+        left.bids[left.count + 1 + i] = right.bids[i];
+    }
+    for (unsigned int i = 0; i <= right.count; i++) {
+        left.children[left.count + 1 + i] = right.children[i];
+    }
+    left.count += right.count + 1;
+    freeInners.push_back(rightIndex);
+
+    removeSeparator(separator);
 }
 
 /**
- * Traverse the tree in pre-order
+ * Takes a separator and the child to its right out of the inner node
+ * at the end of the path, then rebalances that node if it fell under
+ * MIN_KEYS, or drops the root when it is left with one child
+ *
+ * @param slot The separator's slot
  */
-void BinarySearchTree::PreOrder() {
-    // Calls preOrder function with root as argument
-    this->preOrder(root);
+void BPlusTree::removeSeparator(unsigned int slot) {
+    uint32_t innerIndex = path.back().first;
+    path.pop_back();
+
+    Inner &inner = inners[innerIndex];
+    for (unsigned int i = slot + 1; i < inner.count; i++) {
+        inner.keys[i - 1] = inner.keys[i];
+        inner.bids[i - 1] = inner.bids[i];
+    }
+    for (unsigned int i = slot + 2; i <= inner.count; i++) {
+        inner.children[i - 1] = inner.children[i];
+    }
+    inner.count--;
+
+    if (path.empty()) {
+        if (inner.count == 0) {
+            root = inner.children[0];
+            levels--;
+            freeInners.push_back(innerIndex);
+        }
+        return;
+    }
+    if (inner.count < MIN_KEYS) {
+        rebalanceInner(innerIndex);
+    }
 }
 
 /**
- * Insert a bid
+ * Find the bid with the specified bidId, without copying it
+ *
+ * @param bidId The bid id to search for
+ * @return The bid, or nullptr when it isn't found. It stays valid
+ *         until the next Insert or Remove.
  */
-void BinarySearchTree::Insert(Bid bid) {
-    // If the tree is empty, this node is the root.
-    if (root == nullptr) {
-        root = new Node(bid);
+const Bid* BPlusTree::Find(string_view bidId) const {
+    Key key = makeKey(bidId);
+    uint32_t node = root;
+    for (unsigned int level = 0; level < levels; level++) {
+        const Inner &inner = inners[node];
+        prefetchKeys(inner.keys, inner.count);
+        node = inner.children[upperBound(inner, bidId, key)];
     }
-    // Otherwise, call the add node function with the root and new bid
-    else {
-        this->addNode(root, bid);
+
+    const Leaf &leaf = leaves[node];
+    prefetchKeys(leaf.keys, leaf.count);
+    unsigned int slot = lowerBound(leaf, bidId, key);
+    if (slot == leaf.count || compare(bidId, key, leaf.keys[slot], leaf.bids[slot]) != 0) {
+        return nullptr;
     }
+    return &bids[leaf.bids[slot]];
 }
 
 /**
- * Remove a bid
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ * @return A copy of the bid, or an empty bid when it isn't found
  */
-void BinarySearchTree::Remove(string bidId) {
-    // remove node root bidID
-    this->removeNode(root, bidId);
+Bid BPlusTree::Search(string_view bidId) const {
+    const Bid* bid = Find(bidId);
+    if (bid == nullptr) {
+        return Bid();
+    }
+    return *bid;
 }
 
 /**
- * Search for a bid
+ * Visit every bid in id order, along the linked leaves
+ *
+ * @param visit Function called with each bid
  */
-Bid BinarySearchTree::Search(string bidId) {
-    // Sets current node equal to root
-    // Starts searching from the root
-    Node* current = root;
+void BPlusTree::ForEach(const function<void(const Bid &)> &visit) const {
+    // The leftmost leaf is reached through the first child of each level
+    uint32_t node = root;
+    for (unsigned int level = 0; level < levels; level++) {
+        node = inners[node].children[0];
+    }
 
-    // Keeps looping downwards until bottom reached or matching bidId found
-    while (current != nullptr) {
-        // Base case: We found a matching bid
-        if (current->bid.bidId.compare(bidId) == 0) {
-            return current->bid;
-        }
-        // If bid is smaller than current node, then traverse left
-        if (bidId.compare(current->bid.bidId) < 0) {
-            current = current->left;
-        }
-        // Otherwise, the value is greater than the current node, Traverse right.
-        else {
-            current = current->right;
+    for (; node != NONE; node = leaves[node].next) {
+        const Leaf &leaf = leaves[node];
+        for (unsigned int i = 0; i < leaf.count; i++) {
+            visit(bids[leaf.bids[i]]);
         }
     }
-
-    // Returns an empty bid because it was not found in left/right nodes
-    Bid bid;
-    return bid;
 }
 
 /**
- * Add a bid to some node (recursive)
+ * Visit, in id order, every bid with an id from low to high, both
+ * included: down to the leaf low belongs in, then along the leaves
+ * until an id passes high.
  *
- * @param node Current node in tree
- * @param bid Bid to be added
+ * @param low Smallest id to visit
+ * @param high Largest id to visit
+ * @param visit Function called with each bid in the range
  */
-void BinarySearchTree::addNode(Node* node, Bid bid) {
-    // if node is larger than the bid, add to left subtree
-    if (node->bid.bidId.compare(bid.bidId) > 0) {
-        // Base case: If the left child does not exist, insert the new bid as the left child
-        if (node->left == nullptr) {
-            node->left = new Node(bid);
-        }
-        // If it already has a left child, we recursively call addNode
-        // to search for a spot for the new bid
-        else {
-            this->addNode(node->left, bid);
-        }
-    }
-    // Add to right subtree
-    else {
-        // Base case: If the right child does not exist, insert the new bid as the right child
-        if (node->right == nullptr) {
-            node->right = new Node(bid);
-        }
-        // If it already has a right child, we recursively call addNode
-        // to search for a spot for the new bid
-        else {
-            this->addNode(node->right, bid);
-        }
-
+void BPlusTree::RangeQuery(string_view low, string_view high, const function<void(const Bid &)> &visit) const {
+    Key lowKey = makeKey(low);
+    Key highKey = makeKey(high);
+    uint32_t node = root;
+    for (unsigned int level = 0; level < levels; level++) {
+        const Inner &inner = inners[node];
+        node = inner.children[upperBound(inner, low, lowKey)];
     }
-}
 
-Node* BinarySearchTree::removeNode(Node* node, string bidId) {
-    // Base case: Bottom of the tree, parent has no children
-    if (node == nullptr) {
-        return node;
-    }
-    // Recurse down the left subtree (node smaller than bid)
-    if (bidId.compare(node->bid.bidId) < 0) {
-        node->left = removeNode(node->left, bidId);
-    }
-    // Recurse down the right subtree (node bigger than bid)
-    else if ((bidId.compare(node->bid.bidId) > 0)) {
-        node->right = removeNode(node->right, bidId);
-    }
-    else {
-        // Leaf node with no children
-        if (node->left == nullptr && node->right == nullptr) {
-            delete node;
-            node = nullptr;
-        }
-        // One child to the left
-        else if (node->left != nullptr && node->right == nullptr) {
-            Node* temp = node; // Temporary node pointer to copy the node
-            node = node->left;
-            delete temp;
-        }
-        // One child to the right
-        else if (node->right != nullptr && node->left == nullptr) {
-            Node *temp = node; // Temporary node pointer to copy the node
-            node = node->right;
-            delete temp;
-        }
-        // Two children
-        else {
-            Node* temp = node->right;
-            while (temp->left != nullptr) {
-                temp = temp->left;
+    // The first leaf is read from the first id at or above low, the rest whole
+    unsigned int slot = lowerBound(leaves[node], low, lowKey);
+    for (; node != NONE; node = leaves[node].next) {
+        const Leaf &leaf = leaves[node];
+        for (; slot < leaf.count; slot++) {
+            if (compare(high, highKey, leaf.keys[slot], leaf.bids[slot]) < 0) {
+                return;
             }
-            node->bid = temp->bid;
-            node->right = removeNode(node->right, temp->bid.bidId);
+            visit(bids[leaf.bids[slot]]);
         }
+        slot = 0;
     }
-    return node;
 }
-void BinarySearchTree::inOrder(Node* node) {
-    if (node != nullptr) {
-        inOrder(node->left);
-        cout << node->bid.bidId << ": " << node->bid.title << " | " << node->bid.amount << " | "
-             << node->bid.fund << endl;
-        inOrder(node->right);
-    }
+
+/**
+ * @return The number of bids in the tree
+ */
+unsigned int BPlusTree::Size() const {
+    return count;
 }
-void BinarySearchTree::postOrder(Node* node) {
-    if (node != nullptr) {
-        postOrder(node->left);
-        postOrder(node->right);
-        cout << node->bid.bidId << ": " << node->bid.title << " | " << node->bid.amount << " | "
-             << node->bid.fund << endl;
-    }
+
+/**
+ * @return The number of levels, 1 when the root is a leaf
+ */
+unsigned int BPlusTree::Height() const {
+    return levels + 1;
 }
 
-void BinarySearchTree::preOrder(Node* node) {
-    if (node != nullptr) {
-        cout << node->bid.bidId << ": " << node->bid.title << " | " << node->bid.amount << " | "
-             << node->bid.fund << endl;
-        preOrder(node->left);
-        preOrder(node->right);
-    }
+/**
+ * @return The bytes taken by the nodes, beside the bids
+ */
+size_t BPlusTree::IndexBytes() const {
+    return leaves.capacity() * sizeof(Leaf) + inners.capacity() * sizeof(Inner);
 }
 
 //============================================================================
@@ -299,7 +1516,7 @@ void loadBids(string csvPath, BinarySearchTree* bst) {
     cout << "Loading CSV file " << csvPath << endl;
 
     // initialize the CSV Parser using the given path
-    csv::Parser file = csv::Parser(csvPath);
+    csv::Reader file = csv::Reader(csvPath);
 
     // read and display header row - optional
     vector<string> header = file.getHeader();
@@ -309,20 +1526,30 @@ void loadBids(string csvPath, BinarySearchTree* bst) {
     cout << "" << endl;
 
     try {
+        // Resolves each column by name once so rows are indexed without a lookup.
+        // The Dec 2016 extract names its columns differently from the monthly exports.
+        const csv::ColumnHandle titleColumn = file.column({"Auction Title", "ArticleTitle"});
+        const csv::ColumnHandle idColumn = file.column({"Auction ID", "ArticleID"});
+        const csv::ColumnHandle amountColumn = file.column({"Winning Bid", "WinningBid"});
+        const csv::ColumnHandle fundColumn = file.column("Fund");
+
+        // Only these columns are kept, the tokenizer skips the rest of each line
+        file.project({titleColumn.index, idColumn.index, amountColumn.index, fundColumn.index});
+
         // loop to read rows of a CSV file
-        for (unsigned int i = 0; i < file.rowCount(); i++) {
+        for (const csv::Row &row : file) {
 
             // Create a data structure and add to the collection of bids
             Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+            bid.bidId = row[idColumn];
+            bid.title = row[titleColumn];
+            bid.fund = row[fundColumn];
+            bid.amount = row.getCurrency(amountColumn);
 
             //cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
 
             // push this bid to the end
-            bst->Insert(bid);
+            bst->Insert(std::move(bid));
         }
     } catch (csv::Error &e) {
         std::cerr << e.what() << std::endl;
@@ -330,16 +1557,52 @@ void loadBids(string csvPath, BinarySearchTree* bst) {
 }
 
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
+ * Save every bid in the tree to a binary snapshot file
  *
- * credit: http://stackoverflow.com/a/24875936
+ * @param snapshotPath the path of the snapshot file to write
+ * @param bst the tree holding the bids
+ */
+void saveSnapshot(const string &snapshotPath, BinarySearchTree* bst) {
+    try {
+        snapshot::Writer writer;
+        bst->ForEach([&writer](const Bid &bid) {
+            writer.add(bid.bidId, bid.title, bid.fund, bid.amount);
+        });
+        writer.save(snapshotPath);
+        cout << writer.size() << " bids saved to " << snapshotPath << endl;
+    } catch (snapshot::Error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+/**
+ * Load bids from a binary snapshot file instead of parsing the CSV file
  *
- * @param ch The character to strip out
+ * @param snapshotPath the path of the snapshot file to read
+ * @param bst the tree to add the bids to
  */
-double strToDouble(string str, char ch) {
-    str.erase(remove(str.begin(), str.end(), ch), str.end());
-    return atof(str.c_str());
+void loadSnapshot(const string &snapshotPath, BinarySearchTree* bst) {
+    cout << "Loading snapshot " << snapshotPath << endl;
+
+    try {
+        // Maps the file, the records are read straight out of the mapping
+        snapshot::Reader snap = snapshot::Reader(snapshotPath);
+
+        for (unsigned int i = 0; i < snap.size(); i++) {
+            Bid bid;
+            bid.bidId = string(snap.bidId(i));
+            bid.title = string(snap.title(i));
+            bid.fund = string(snap.fund(i));
+            bid.amount = snap.amount(i);
+
+            bst->Insert(std::move(bid));
+        }
+    } catch (snapshot::Error &e) {
+        std::cerr << e.what() << std::endl;
+    } catch (csv::Error &e) {
+        // Opening and mapping the file is shared with the CSV parser
+        std::cerr << e.what() << std::endl;
+    }
 }
 
 /**
@@ -354,6 +1617,303 @@ void displayTelemetry(clock_t ticks) {
     cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 }
 
+/**
+ * Times Search for ids the tree holds and ids it doesn't, and prints
+ * the average latency of each.
+ *
+ * @param name - the label in the report
+ * @param bst - the tree to search
+ * @param hits - ids that are in the tree
+ * @param misses - ids that are not in the tree
+ */
+template <typename Tree>
+void timeLookups(const string &name, Tree* bst, const vector<string> &hits, const vector<string> &misses) {
+    unsigned int found = 0;
+
+    clock_t ticks = clock();
+    for (const string &id : hits) {
+        found += !bst->Search(id).bidId.empty();
+    }
+    double hitSeconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    ticks = clock();
+    for (const string &id : misses) {
+        found += !bst->Search(id).bidId.empty();
+    }
+    double missSeconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    cout << "  " << name << ": hit " << hitSeconds * 1e9 / hits.size() << " ns, miss "
+         << missSeconds * 1e9 / misses.size() << " ns per lookup (" << found << " found)" << endl;
+}
+
+/**
+ * Times lookups without and then with the Bloom filter, and reports
+ * the filter's false positive rate, measured on the misses and
+ * estimated from its fill, and its memory cost.
+ *
+ * @param name - the label of the bid set in the report
+ * @param bst - the tree, holding every id in hits
+ * @param hits - ids that are in the tree
+ * @param misses - ids that are not in the tree
+ */
+void reportFilter(const string &name, BinarySearchTree* bst, const vector<string> &hits,
+                  const vector<string> &misses) {
+    cout << name << ":" << endl;
+    bst->DisableFilter();
+    timeLookups("without filter", bst, hits, misses);
+    bst->EnableFilter();
+    timeLookups("with filter", bst, hits, misses);
+
+    const bloom::Filter &filter = bst->GetFilter();
+    unsigned int passed = 0;
+    for (const string &id : misses) {
+        passed += filter.mayContain(BinarySearchTree::hashId(id));
+    }
+    cout << "  false positives: " << passed * 100.0 / misses.size() << "% measured, "
+         << filter.falsePositiveRate() * 100.0 << "% estimated" << endl;
+    cout << "  filter memory: " << filter.bytes() << " bytes, "
+         << filter.bytes() * 8.0 / bst->Size() << " bits per bid" << endl;
+}
+
+/**
+ * Shows what the Bloom filter does for misses on the bids in the CSV
+ * file and on a million synthetic bids inserted in random order.
+ *
+ * @param csvPath - the path to the CSV file
+ */
+void benchmarkFilter(const string &csvPath) {
+    const unsigned int synthetic = 1000000;
+    mt19937 random(42);
+    vector<string> hits;
+    vector<string> misses;
+
+    BinarySearchTree* bst = new BinarySearchTree();
+    loadBids(csvPath, bst);
+    bst->ForEach([&hits, &misses](const Bid &bid) {
+        hits.push_back(bid.bidId);
+        misses.push_back(bid.bidId + "-x");
+    });
+    shuffle(hits.begin(), hits.end(), random);
+    reportFilter(to_string(hits.size()) + " bids from " + csvPath, bst, hits, misses);
+    delete bst;
+
+    hits.clear();
+    misses.clear();
+    bst = new BinarySearchTree();
+    uniform_int_distribution<unsigned int> pick(0, 899999999);
+    for (unsigned int i = 0; i < synthetic; i++) {
+        Bid bid;
+        bid.bidId = to_string(100000000 + pick(random));
+        bid.title = "Synthetic Bid";
+        bid.fund = "General Fund";
+        hits.push_back(bid.bidId);
+        misses.push_back(bid.bidId + "-x");
+        bst->Insert(std::move(bid));
+    }
+    shuffle(hits.begin(), hits.end(), random);
+    reportFilter(to_string(synthetic) + " synthetic bids", bst, hits, misses);
+    delete bst;
+}
+
+/**
+ * Inserts bids with the given ids into a new tree in the given order,
+ * then reports the insert time, the tree's height and lookup latency.
+ *
+ * @param name - the tree's label in the report
+ * @param balanced - whether the tree balances itself
+ * @param ids - the ids to insert, in insertion order
+ * @param misses - ids that are not in the tree
+ */
+void timeTree(const string &name, bool balanced, const vector<string> &ids, const vector<string> &misses) {
+    BinarySearchTree* bst = new BinarySearchTree(balanced);
+
+    clock_t ticks = clock();
+    for (const string &id : ids) {
+        Bid bid;
+        bid.bidId = id;
+        bid.title = "Synthetic Bid";
+        bid.fund = "General Fund";
+        bst->Insert(std::move(bid));
+    }
+    double seconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    cout << "  " << name << ": " << ids.size() << " inserts in " << seconds << " seconds, height "
+         << bst->Height() << endl;
+
+    // Looked up in an order unrelated to how they went in
+    vector<string> hits = ids;
+    shuffle(hits.begin(), hits.end(), mt19937(7));
+    timeLookups(name, bst, hits, misses);
+    delete bst;
+}
+
+/**
+ * Compares the plain and the balanced tree on bids inserted sorted by
+ * id, in reverse, and in random order. The plain tree degenerates into
+ * a list on sorted input, so it only gets a small set; the balanced
+ * tree then runs the same orders on a million bids.
+ */
+void benchmarkBalance() {
+    const unsigned int small = 20000;
+    const unsigned int large = 1000000;
+    const string orders[] = {"sorted", "reverse-sorted", "random"};
+
+    for (unsigned int bids : {small, large}) {
+        // Ids of the same length sort as their numbers do
+        vector<string> ids;
+        vector<string> misses;
+        for (unsigned int i = 0; i < bids; i++) {
+            ids.push_back(to_string(100000000 + 2 * i));
+            misses.push_back(to_string(100000001 + 2 * i));
+        }
+        shuffle(misses.begin(), misses.end(), mt19937(42));
+
+        for (const string &order : orders) {
+            if (order == "reverse-sorted") {
+                reverse(ids.begin(), ids.end());
+            } else if (order == "random") {
+                shuffle(ids.begin(), ids.end(), mt19937(42));
+            }
+
+            cout << bids << " bids, " << order << ":" << endl;
+            if (bids == small) {
+                timeTree("plain", false, ids, misses);
+            }
+            timeTree("balanced", true, ids, misses);
+        }
+    }
+}
+
+/**
+ * Fills a tree with bids of the given ids and reports the insert
+ * time, a lookup of every id in random order, and an in-order scan
+ *
+ * @param name - the tree's label in the report
+ * @param tree - the empty tree to fill
+ * @param ids - the ids to insert, in insertion order
+ * @param hits - the ids to look up
+ * @param misses - ids that are not in the tree
+ */
+template <typename Tree>
+void timeIndex(const string &name, Tree* tree, const vector<string> &ids, const vector<string> &hits,
+               const vector<string> &misses) {
+    clock_t ticks = clock();
+    for (const string &id : ids) {
+        Bid bid;
+        bid.bidId = id;
+        bid.title = "Synthetic Bid";
+        bid.fund = "General Fund";
+        tree->Insert(std::move(bid));
+    }
+    double insertSeconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    double total = 0.0;
+    ticks = clock();
+    tree->ForEach([&total](const Bid &bid) {
+        total += bid.amount;
+    });
+    double scanSeconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    cout << "  " << name << ": " << ids.size() << " inserts in " << insertSeconds << " seconds, height "
+         << tree->Height() << ", in-order scan " << scanSeconds * 1e9 / tree->Size() << " ns per bid" << endl;
+    timeLookups(name, tree, hits, misses);
+}
+
+/**
+ * Removes every other id from a filled tree and reports the time,
+ * then checks the tree against what should be left: every removed
+ * id is missing, every kept one is found, and a range query over
+ * all the ids visits just the kept ones, each above the one before.
+ *
+ * @param name - the tree's label in the report
+ * @param tree - the tree holding every id in ids
+ * @param ids - the ids in the tree, in random order
+ */
+template <typename Tree>
+void timeRemoves(const string &name, Tree* tree, const vector<string> &ids) {
+    clock_t ticks = clock();
+    for (size_t i = 0; i < ids.size(); i += 2) {
+        tree->Remove(ids[i]);
+    }
+    double seconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    unsigned int wrong = 0;
+    for (size_t i = 0; i < ids.size(); i++) {
+        bool found = !tree->Search(ids[i]).bidId.empty();
+        wrong += found != (i % 2 == 1);
+    }
+
+    auto span = minmax_element(ids.begin(), ids.end());
+    string last;
+    unsigned int scanned = 0;
+    tree->RangeQuery(*span.first, *span.second, [&wrong, &last, &scanned](const Bid &bid) {
+        wrong += scanned > 0 && bid.bidId <= last;
+        last = bid.bidId;
+        scanned++;
+    });
+    wrong += scanned != ids.size() / 2;
+
+    cout << "  " << name << ": " << ids.size() - ids.size() / 2 << " removes in " << seconds
+         << " seconds, height " << tree->Height() << ", " << ((wrong == 0) ? "lookups and range match"
+         : to_string(wrong) + " lookups or range steps wrong") << endl;
+}
+
+/**
+ * Compares the AVL tree with the B+ tree index on one and four
+ * million synthetic bids inserted in random order, then removes
+ * half of them from each and checks what is left
+ */
+void benchmarkIndex() {
+    mt19937 random(42);
+
+    for (unsigned int bids : {1000000u, 4000000u}) {
+        vector<string> ids;
+        vector<string> misses;
+        for (unsigned int i = 0; i < bids; i++) {
+            ids.push_back(to_string(100000000 + 2 * i));
+            misses.push_back(to_string(100000001 + 2 * i));
+        }
+        shuffle(ids.begin(), ids.end(), random);
+        shuffle(misses.begin(), misses.end(), random);
+        vector<string> hits = ids;
+        shuffle(hits.begin(), hits.end(), random);
+
+        cout << bids << " synthetic bids:" << endl;
+        BinarySearchTree* bst = new BinarySearchTree();
+        timeIndex("AVL tree", bst, ids, hits, misses);
+        timeRemoves("AVL tree", bst, hits);
+        delete bst;
+
+        BPlusTree* index = new BPlusTree();
+        timeIndex("B+ tree", index, ids, hits, misses);
+        cout << "  B+ tree nodes: " << index->IndexBytes() * 1.0 / index->Size() << " bytes per bid" << endl;
+        timeRemoves("B+ tree", index, hits);
+        delete index;
+    }
+}
+
+/**
+ * Runs one benchmark, picked by name on the command line with
+ * --bench, instead of the menu.
+ *
+ * @param name - the benchmark to run
+ * @param csvPath - the path to the CSV file the benchmark reads
+ * @return 0, or 1 when there is no benchmark by that name
+ */
+int runBenchmark(const string &name, const string &csvPath) {
+    if (name == "filter") {
+        benchmarkFilter(csvPath);
+    } else if (name == "balance") {
+        benchmarkBalance();
+    } else if (name == "index") {
+        benchmarkIndex();
+    } else {
+        cerr << "Unknown benchmark " << name << ", expected one of: filter, balance, index" << endl;
+        return 1;
+    }
+    return 0;
+}
+
 /**
  *
  * Handles and checks command-line arguments during execution and stores the csv file path into a variable
@@ -388,6 +1948,7 @@ string processCommandLine(int argc, char* argv[]) {
 void mainMenu(const string &path) {
 
     const string &csvPath = path;
+    const string snapshotPath = csvPath + ".snap";
     string bidKey = {};
     clock_t ticks;
 
@@ -397,13 +1958,18 @@ void mainMenu(const string &path) {
     Bid bid;
 
     int choice = 0;
-    while (choice != 9) {
+    while (choice != 10) {
         cout << "Menu:" << endl;
         cout << "  1. Load Bids" << endl;
         cout << "  2. Display All Bids" << endl;
         cout << "  3. Find Bid" << endl;
         cout << "  4. Remove Bid" << endl;
-        cout << "  9. Exit" << endl;
+        cout << "  5. Save Snapshot" << endl;
+        cout << "  6. Load Snapshot" << endl;
+        cout << "  7. Find Bids in Range" << endl;
+        cout << "  8. Find Bids by Prefix" << endl;
+        cout << "  9. Page Through Bids" << endl;
+        cout << "  10. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
 
@@ -462,6 +2028,84 @@ void mainMenu(const string &path) {
                     cout << "Returning to Menu..." << endl;
                 }
                 break;
+
+            case 5:
+                saveSnapshot(snapshotPath, bst);
+                break;
+
+            case 6:
+                ticks = clock();
+
+                loadSnapshot(snapshotPath, bst);
+
+                displayTelemetry(ticks);
+                break;
+
+            case 7: {
+                string highKey;
+                unsigned int found = 0;
+                cout << "Enter lowest and highest bid ID:" << endl;
+                cin >> bidKey >> highKey;
+
+                ticks = clock();
+                bst->RangeQuery(bidKey, highKey, [&found](const Bid &match) {
+                    displayBid(match);
+                    found++;
+                });
+                cout << found << " bids from " << bidKey << " to " << highKey << endl;
+                displayTelemetry(ticks);
+                break;
+            }
+
+            case 8: {
+                unsigned int found = 0;
+                cout << "Enter bid ID prefix:" << endl;
+                cin >> bidKey;
+
+                ticks = clock();
+                bst->PrefixQuery(bidKey, [&found](const Bid &match) {
+                    displayBid(match);
+                    found++;
+                });
+                cout << found << " bids starting with " << bidKey << endl;
+                displayTelemetry(ticks);
+                break;
+            }
+
+            case 9: {
+                long long page = 0;
+                long long pageSize = 0;
+                cout << "Enter page number (from 1) and bids per page:" << endl;
+                cin >> page >> pageSize;
+                if (!cin || page < 1 || pageSize < 1) {
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    cout << "Page number and bids per page must both be at least 1." << endl;
+                    break;
+                }
+
+                // Positions are worked out in size_t and checked, so a huge page
+                // number can't wrap around to a page near the front
+                size_t size = bst->Size();
+                size_t skipped = static_cast<size_t>(page - 1);
+                size_t perPage = static_cast<size_t>(pageSize);
+                size_t pages = (size + perPage - 1) / perPage;
+                if (skipped > SIZE_MAX / perPage || skipped * perPage >= size) {
+                    cout << "Page " << page << " is past the last page, " << pages << "." << endl;
+                    break;
+                }
+
+                ticks = clock();
+                size_t offset = skipped * perPage;
+                unsigned int limit = static_cast<unsigned int>(min(perPage, size - offset));
+                for (const Bid &match : bst->Page(static_cast<unsigned int>(offset), limit)) {
+                    cout << ++offset << ". ";
+                    displayBid(match);
+                }
+                cout << "page " << page << " of " << pages << endl;
+                displayTelemetry(ticks);
+                break;
+            }
         }
     }
     cout << "Goodbye." << endl;
@@ -471,10 +2115,17 @@ void mainMenu(const string &path) {
 /**
  * The one and only main() method
  *
+ * BinarySearchTree [csvPath] opens the menu, BinarySearchTree --bench
+ * <name> [csvPath] runs one benchmark and exits.
+ *
  * @param arg[1] path to CSV file to load from (optional)
  * @param arg[2] the bid Id to use when searching the list (optional)
  */
 int main(int argc, char* argv[]) {
+    if (argc >= 3 && string(argv[1]) == "--bench") {
+        // The arguments after the name are read as if the name were the program
+        return runBenchmark(argv[2], processCommandLine(argc - 2, argv + 2));
+    }
     mainMenu(processCommandLine(argc, argv));
     return 0;
 }
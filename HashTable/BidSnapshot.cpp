@@ -0,0 +1,190 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include "BidSnapshot.hpp"
+
+namespace snapshot {
+
+    static const char MAGIC[8] = {'B', 'I', 'D', 'S', 'N', 'A', 'P', '\0'};
+
+    static_assert(sizeof(Header) == 24, "snapshot header must not be padded");
+    static_assert(sizeof(Record) == 40, "snapshot record must not be padded");
+
+    // where a long id's (offset, length) in the blob sits in its id field
+    static const std::size_t LONG_ID_AT = 8;
+
+    /*
+    ** Reads the id field of a record: an inline id, or the span of a long
+    ** one in the blob. An empty id, all zeroes, is an empty span.
+    */
+    static bool longId(const char *field, std::uint32_t &offset, std::uint32_t &length)
+    {
+        std::uint32_t span[2];
+
+        if (field[0] != '\0')
+            return false;
+        std::memcpy(span, field + LONG_ID_AT, sizeof(span));
+        offset = span[0];
+        length = span[1];
+        return true;
+    }
+
+    /*
+    ** WRITER
+    */
+
+    Writer::Writer(void) {}
+
+    Writer::~Writer(void) {}
+
+    void Writer::add(std::string_view bidId, std::string_view title, std::string_view fund, double amount)
+    {
+        Record record;
+
+        if (_blob.size() + bidId.size() + title.size() + fund.size() > std::numeric_limits<std::uint32_t>::max())
+            throw Error("too much text for one snapshot");
+
+        std::memset(record.bidId, 0, ID_WIDTH);
+        // a zero byte would end an inline id early, so such an id goes in the blob too
+        if (bidId.size() <= ID_WIDTH && bidId.find('\0') == std::string_view::npos)
+            std::memcpy(record.bidId, bidId.data(), bidId.size());
+        else
+        {
+            std::uint32_t span[2] = {std::uint32_t(_blob.size()), std::uint32_t(bidId.size())};
+            std::memcpy(record.bidId + LONG_ID_AT, span, sizeof(span));
+            _blob.append(bidId);
+        }
+
+        record.titleOffset = _blob.size();
+        record.titleLength = title.size();
+        _blob.append(title);
+
+        record.fundOffset = _blob.size();
+        record.fundLength = fund.size();
+        _blob.append(fund);
+
+        record.cents = std::llround(amount * 100.0);
+        _records.push_back(record);
+    }
+
+    unsigned int Writer::size(void) const
+    {
+        return _records.size();
+    }
+
+    void Writer::save(const std::string &path) const
+    {
+        Header header;
+
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.count = _records.size();
+        header.blobSize = _blob.size();
+
+        std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            throw Error(std::string("Failed to open ").append(path));
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(_records.data()), _records.size() * sizeof(Record));
+        file.write(_blob.data(), _blob.size());
+        file.close();
+
+        if (!file)
+            throw Error(std::string("Failed to write ").append(path));
+    }
+
+    /*
+    ** READER
+    */
+
+    Reader::Reader(const std::string &path)
+            : _file(path), _count(0), _records(nullptr), _blob(nullptr)
+    {
+        Header header;
+
+        if (_file.size() < sizeof(header))
+            throw Error(std::string("not a bid snapshot: ").append(path));
+
+        std::memcpy(&header, _file.data(), sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+            throw Error(std::string("not a bid snapshot: ").append(path));
+        if (header.version < 1 || header.version > VERSION)
+            throw Error(std::string("unsupported snapshot version in ").append(path));
+
+        // the sizes in the header have to add up to the file before any view is handed out
+        std::uint64_t expected = sizeof(header) + std::uint64_t(header.count) * sizeof(Record) + header.blobSize;
+        if (expected != _file.size())
+            throw Error(std::string("truncated or corrupted snapshot: ").append(path));
+
+        _count = header.count;
+        _records = _file.data() + sizeof(header);
+        _blob = _records + std::size_t(_count) * sizeof(Record);
+
+        for (unsigned int i = 0; i < _count; i++)
+        {
+            Record r = record(i);
+            std::uint32_t idOffset = 0;
+            std::uint32_t idLength = 0;
+            longId(r.bidId, idOffset, idLength);
+            if (std::uint64_t(r.titleOffset) + r.titleLength > header.blobSize ||
+                std::uint64_t(r.fundOffset) + r.fundLength > header.blobSize ||
+                std::uint64_t(idOffset) + idLength > header.blobSize)
+                throw Error(std::string("truncated or corrupted snapshot: ").append(path));
+        }
+    }
+
+    Reader::~Reader(void) {}
+
+    Record Reader::record(unsigned int pos) const
+    {
+        Record r;
+
+        if (pos >= _count)
+            throw Error("can't return this record (doesn't exist)");
+        // memcpy keeps unaligned mappings safe, it compiles down to plain loads
+        std::memcpy(&r, _records + std::size_t(pos) * sizeof(Record), sizeof(Record));
+        return r;
+    }
+
+    unsigned int Reader::size(void) const
+    {
+        return _count;
+    }
+
+    std::string_view Reader::bidId(unsigned int pos) const
+    {
+        const char *id = _records + std::size_t(pos) * sizeof(Record);
+        std::uint32_t offset;
+        std::uint32_t length;
+
+        if (pos >= _count)
+            throw Error("can't return this record (doesn't exist)");
+        if (longId(id, offset, length))
+            return std::string_view(_blob + offset, length);
+        return std::string_view(id, strnlen(id, ID_WIDTH));
+    }
+
+    std::string_view Reader::title(unsigned int pos) const
+    {
+        Record r = record(pos);
+        return std::string_view(_blob + r.titleOffset, r.titleLength);
+    }
+
+    std::string_view Reader::fund(unsigned int pos) const
+    {
+        Record r = record(pos);
+        return std::string_view(_blob + r.fundOffset, r.fundLength);
+    }
+
+    std::int64_t Reader::cents(unsigned int pos) const
+    {
+        return record(pos).cents;
+    }
+
+    double Reader::amount(unsigned int pos) const
+    {
+        return record(pos).cents / 100.0;
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef HASHTABLE_BIDSNAPSHOT_HPP
+#define HASHTABLE_BIDSNAPSHOT_HPP
+
+# include <cstdint>
+# include <stdexcept>
+# include <string>
+# include <string_view>
+# include <vector>
+
+# include "CSVparser.hpp"
+
+/*
+** Compact binary snapshot of a bid collection, so a program can restart
+** from it instead of parsing the CSV export again.
+**
+** Layout (version 2, native little-endian):
+**   header   magic "BIDSNAP", version, record count, blob size
+**   records  fixed 40 bytes each: 16 byte id field, title and fund
+**            as (offset, length) into the blob, amount in integer cents
+**   blob     the title and fund text, and any long id, back to back
+**
+** An id of up to 16 bytes sits in its field, zero-padded. A longer one
+** goes in the blob: its field starts with a zero byte, which an inline
+** id never does, and holds the id's (offset, length) at byte 8. Version
+** 1 files only have inline ids and read the same.
+**
+** Reading maps the file and hands out views into it, nothing is parsed.
+*/
+namespace snapshot
+{
+    class Error : public std::runtime_error
+    {
+
+    public:
+        Error(const std::string &msg):
+                std::runtime_error(std::string("BidSnapshot : ").append(msg))
+        {
+        }
+    };
+
+    const unsigned int VERSION = 2;
+    const unsigned int ID_WIDTH = 16;
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t count;
+        std::uint64_t blobSize;
+    };
+
+    struct Record
+    {
+        char bidId[ID_WIDTH];
+        std::uint32_t titleOffset;
+        std::uint32_t titleLength;
+        std::uint32_t fundOffset;
+        std::uint32_t fundLength;
+        std::int64_t cents;
+    };
+
+    class Writer
+    {
+
+    public:
+        Writer(void);
+        ~Writer(void);
+
+    public:
+        void add(std::string_view bidId, std::string_view title, std::string_view fund, double amount);
+        unsigned int size(void) const;
+        void save(const std::string &path) const;
+
+    private:
+        std::vector<Record> _records;
+        std::string _blob;
+    };
+
+    class Reader
+    {
+
+    public:
+        Reader(const std::string &path);
+        ~Reader(void);
+
+    public:
+        unsigned int size(void) const;
+        std::string_view bidId(unsigned int) const;
+        std::string_view title(unsigned int) const;
+        std::string_view fund(unsigned int) const;
+        std::int64_t cents(unsigned int) const;
+        double amount(unsigned int) const;
+
+    private:
+        Record record(unsigned int) const;
+
+    private:
+        csv::MappedFile _file;
+        unsigned int _count;
+        const char *_records;
+        const char *_blob;
+    };
+}
+
+#endif //HASHTABLE_BIDSNAPSHOT_HPP
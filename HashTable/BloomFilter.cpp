@@ -0,0 +1,106 @@
+#include "BloomFilter.hpp"
+
+namespace bloom {
+
+    // Odd multipliers that spread the low half of a hash into one bit
+    // position per word (the split block layout of Parquet's filters)
+    static const std::uint32_t SALT[8] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+    };
+
+    static inline std::uint64_t bit(std::uint64_t hash, unsigned int word)
+    {
+        return std::uint64_t(1) << ((static_cast<std::uint32_t>(hash) * SALT[word]) >> 26);
+    }
+
+    Filter::Filter(void) : _keys(0)
+    {
+        reset(0);
+    }
+
+    Filter::Filter(std::size_t expected) : _keys(0)
+    {
+        reset(expected);
+    }
+
+    Filter::~Filter(void) {}
+
+    /*
+    ** Empties the filter and sizes it for the given number of keys.
+    */
+    void Filter::reset(std::size_t expected)
+    {
+        std::size_t blocks = (expected * BITS_PER_KEY + 511) / 512;
+
+        _blocks.assign(blocks > 0 ? blocks : 1, Block());
+        _keys = 0;
+    }
+
+    std::size_t Filter::index(std::uint64_t hash) const
+    {
+        // the high half picks the block, scaled rather than masked so any
+        // block count works
+        return static_cast<std::size_t>(((hash >> 32) * _blocks.size()) >> 32);
+    }
+
+    void Filter::add(std::uint64_t hash)
+    {
+        Block &target = _blocks[index(hash)];
+
+        for (unsigned int i = 0; i < 8; i++)
+            target.words[i] |= bit(hash, i);
+        _keys++;
+    }
+
+    bool Filter::mayContain(std::uint64_t hash) const
+    {
+        const Block &target = _blocks[index(hash)];
+
+        for (unsigned int i = 0; i < 8; i++)
+            if ((target.words[i] & bit(hash, i)) == 0)
+                return false;
+        return true;
+    }
+
+    std::size_t Filter::keys(void) const
+    {
+        return _keys;
+    }
+
+    /*
+    ** Keys the filter was sized for; past that false positives climb.
+    */
+    std::size_t Filter::capacity(void) const
+    {
+        return _blocks.size() * 512 / BITS_PER_KEY;
+    }
+
+    std::size_t Filter::bytes(void) const
+    {
+        return _blocks.size() * sizeof(Block);
+    }
+
+    /*
+    ** Estimated from how full the words are: a miss passes when the bit
+    ** it checks is set in all eight words of the block it lands in.
+    */
+    double Filter::falsePositiveRate(void) const
+    {
+        double total = 0.0;
+
+        for (std::size_t b = 0; b < _blocks.size(); b++)
+        {
+            double pass = 1.0;
+            for (unsigned int i = 0; i < 8; i++)
+            {
+                unsigned int set = 0;
+                for (std::uint64_t word = _blocks[b].words[i]; word != 0; word &= word - 1)
+                    set++;
+                pass *= set / 64.0;
+            }
+            total += pass;
+        }
+        return total / _blocks.size();
+    }
+}
@@ -5,8 +5,16 @@
 #ifndef HASHTABLE_CSVPARSER_HPP
 #define HASHTABLE_CSVPARSER_HPP
 
+# include <fstream>
+# include <future>
+# include <initializer_list>
+# include <iterator>
+# include <memory>
 # include <stdexcept>
 # include <string>
+# include <string_view>
+# include <type_traits>
+# include <unordered_map>
 # include <vector>
 # include <list>
 # include <sstream>
@@ -23,52 +31,183 @@ namespace csv
         }
     };
 
+    class MappedFile
+    {
+
+    public:
+        MappedFile(const std::string &);
+        ~MappedFile(void);
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+    public:
+        const char *data(void) const;
+        std::size_t size(void) const;
+
+    private:
+        const char *_data;
+        std::size_t _size;
+        std::string _buffer; // only used where mmap isn't available
+    };
+
+    /*
+    ** A column name resolved once against a schema. Rows indexed with it
+    ** skip the name lookup altogether, which is what hot loops should use.
+    */
+    struct ColumnHandle
+    {
+        unsigned int index;
+    };
+
+    /*
+    ** Column names of a file. Every Row parsed from that file points at the
+    ** same immutable instance instead of carrying its own copy. Names are
+    ** matched with surrounding blanks ignored ("Winning Bid " is found as
+    ** "Winning Bid").
+    */
+    class Schema
+    {
+
+    public:
+        Schema(const std::vector<std::string> &);
+        Schema(const std::vector<std::string> &, const std::vector<unsigned int> &columns);
+        ~Schema(void);
+
+    public:
+        unsigned int size(void) const;
+        const std::vector<std::string> &names(void) const;
+        int indexOf(const std::string &) const;
+        ColumnHandle column(const std::string &) const;
+        ColumnHandle column(std::initializer_list<std::string>) const;
+
+    public:
+        // with a projection rows only store the kept columns
+        bool projected(void) const;
+        unsigned int fieldCount(void) const;
+        int slot(unsigned int column) const;
+
+    private:
+        const std::vector<std::string> _names;
+        std::unordered_map<std::string, unsigned int> _index;
+        std::vector<int> _slots;
+        unsigned int _fieldCount;
+    };
+
+    /*
+    ** Columns a Parser or Reader should keep, by position or by name. The
+    ** other fields of a line are skipped by the tokenizer and never copied;
+    ** rows are still indexed by their original column positions.
+    */
+    class Projection
+    {
+
+    public:
+        Projection(void);
+        Projection(std::initializer_list<unsigned int>);
+        Projection(std::initializer_list<std::string>);
+        Projection(const std::vector<unsigned int> &);
+        Projection(const std::vector<std::string> &);
+
+    public:
+        bool empty(void) const;
+        std::vector<unsigned int> resolve(const Schema &) const;
+
+    private:
+        std::vector<unsigned int> _positions;
+        std::vector<std::string> _names;
+    };
+
     class Row
     {
     public:
         Row(const std::vector<std::string> &);
+        Row(const std::shared_ptr<const Schema> &);
         ~Row(void);
 
     public:
         unsigned int size(void) const;
         void push(const std::string &);
+        void pushView(std::string_view);
+        void clear(void);
         bool set(const std::string &, const std::string &);
+        const Schema &schema(void) const;
+        bool has(unsigned int) const;
+        std::string_view view(unsigned int) const;
+        std::string_view view(ColumnHandle) const;
 
     private:
-        const std::vector<std::string> _header;
+        std::string_view field(unsigned int) const;
+
+    private:
+        std::shared_ptr<const Schema> _schema;
         std::vector<std::string> _values;
+        std::vector<std::string_view> _views;
 
     public:
 
+        /*
+        ** Typed accessors parse straight from the field bytes without
+        ** allocating. Blank fields read as 0; anything else that isn't a
+        ** number throws. getCurrency also takes "$3,000 " style amounts.
+        */
+        long long getInteger(unsigned int) const;
+        long long getInteger(ColumnHandle) const;
+        double getDouble(unsigned int) const;
+        double getDouble(ColumnHandle) const;
+        double getCurrency(unsigned int) const;
+        double getCurrency(ColumnHandle) const;
+
         template<typename T>
         const T getValue(unsigned int pos) const
         {
-            if (pos < _values.size())
+            if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value)
+                return static_cast<T>(getInteger(pos));
+            else if constexpr (std::is_floating_point<T>::value)
+                return static_cast<T>(getDouble(pos));
+            else
             {
                 T res;
                 std::stringstream ss;
-                ss << _values[pos];
+                ss << view(pos);
                 ss >> res;
                 return res;
             }
-            throw Error("can't return this value (doesn't exist)");
         }
         const std::string operator[](unsigned int) const;
         const std::string operator[](const std::string &valueName) const;
+        const std::string operator[](ColumnHandle) const;
         friend std::ostream& operator<<(std::ostream& os, const Row &row);
         friend std::ofstream& operator<<(std::ofstream& os, const Row &row);
     };
 
     enum DataType {
         eFILE = 0,
-        ePURE = 1
+        ePURE = 1,
+        eMMAP = 2
+    };
+
+    /*
+    ** The tokenizer finds separators and quotes 32 bytes at a time with the
+    ** widest kernel the CPU supports. A slower one can be forced, e.g. to
+    ** benchmark it; that is not thread-safe against running parsers.
+    */
+    enum ScanKernel {
+        eSCALAR = 0,
+        eSSE2 = 1,
+        eAVX2 = 2
     };
 
+    bool setScanKernel(ScanKernel);
+    ScanKernel getScanKernel(void);
+
     class Parser
     {
 
     public:
-        Parser(const std::string &, const DataType &type = eFILE, char sep = ',');
+        // threads > 1 tokenizes the file in that many chunks at once, 0 uses every core
+        Parser(const std::string &, const DataType &type = eFILE, char sep = ',', unsigned int threads = 1);
+        Parser(const std::string &, const Projection &columns, const DataType &type = eFILE, char sep = ',',
+               unsigned int threads = 1);
         ~Parser(void);
 
     public:
@@ -78,27 +217,125 @@ namespace csv
         std::vector<std::string> getHeader(void) const;
         const std::string getHeaderElement(unsigned int pos) const;
         const std::string &getFileName(void) const;
+        ColumnHandle column(const std::string &) const;
+        ColumnHandle column(std::initializer_list<std::string>) const;
 
     public:
         bool deleteRow(unsigned int row);
         bool addRow(unsigned int pos, const std::vector<std::string> &);
         void sync(void) const;
 
+    public:
+        /*
+        ** Journaled persistence. Once enabled, every addRow/deleteRow is
+        ** appended to <file>.journal right away, so an edit costs the size
+        ** of the change instead of a rewrite of the file. When the journal
+        ** outgrows half the file it is folded back into the file by a
+        ** background compaction; a journal left by an earlier run is
+        ** replayed when the journal is enabled.
+        */
+        void enableJournal(void);
+        bool journaling(void) const;
+        void compact(void);
+        void waitForCompaction(void);
+
     protected:
         void parseHeader(void);
         void parseContent(void);
+        void parseRange(std::string_view, std::shared_ptr<const Schema>, std::vector<Row *> &) const;
+        unsigned int parseLine(std::string_view, Row &) const;
+        std::string serialize(void) const;
+        bool replay(const std::string &path, const std::string &base);
+        void startJournal(const std::string &base);
+        void appendJournal(const std::string &entry);
 
     private:
         std::string _file;
         const DataType _type;
         const char _sep;
-        std::vector<std::string> _originalFile;
+        const unsigned int _threads;
+        const Projection _projection;
+        std::string _buffer;
+        std::unique_ptr<MappedFile> _mapping;
+        std::string_view _data;
+        std::string_view _body;
         std::vector<std::string> _header;
+        std::shared_ptr<const Schema> _schema;
         std::vector<Row *> _content;
+        mutable std::ofstream _journal;
+        std::size_t _journalBytes;
+        std::size_t _compactBytes;
+        std::future<void> _compaction;
 
     public:
         Row &operator[](unsigned int row) const;
     };
+
+    /*
+    ** Forward-only reader. Rows are tokenized out of a fixed-size read
+    ** buffer while they are walked, so memory stays flat however large
+    ** the file is. The Row handed out by the iterator is reused: it (and
+    ** its views) is only valid until the iterator is advanced.
+    */
+    class Reader
+    {
+
+    public:
+        class iterator
+        {
+
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef Row value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const Row *pointer;
+            typedef const Row &reference;
+
+            iterator(Reader *reader = nullptr);
+
+            const Row &operator*(void) const;
+            const Row *operator->(void) const;
+            iterator &operator++(void);
+            bool operator==(const iterator &) const;
+            bool operator!=(const iterator &) const;
+
+        private:
+            Reader *_reader;
+        };
+
+    public:
+        Reader(const std::string &, char sep = ',', std::size_t bufferSize = 64 * 1024);
+        Reader(const std::string &, const Projection &columns, char sep = ',', std::size_t bufferSize = 64 * 1024);
+        ~Reader(void);
+
+    public:
+        iterator begin(void);
+        iterator end(void);
+        unsigned int columnCount(void) const;
+        std::vector<std::string> getHeader(void) const;
+        const std::string &getFileName(void) const;
+        ColumnHandle column(const std::string &) const;
+        ColumnHandle column(std::initializer_list<std::string>) const;
+        // narrows the columns kept from here on, call it before iterating
+        void project(const Projection &);
+
+    protected:
+        bool fill(void);
+        bool nextLine(std::string_view &);
+        bool next(void);
+
+    private:
+        std::string _file;
+        const char _sep;
+        std::ifstream _stream;
+        std::vector<char> _buffer;
+        std::size_t _begin;
+        std::size_t _end;
+        bool _eof;
+        std::vector<std::string> _header;
+        std::shared_ptr<const Schema> _schema;
+        std::unique_ptr<Row> _row;
+    };
 }
 
 #endif //HASHTABLE_CSVPARSER_HPP
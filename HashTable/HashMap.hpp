@@ -0,0 +1,453 @@
+#ifndef HASHTABLE_HASHMAP_HPP
+#define HASHTABLE_HASHMAP_HPP
+
+# include <algorithm>
+# include <cstddef>
+# include <cstdlib>
+# include <functional>
+# include <memory>
+# include <new>
+# include <utility>
+# include <vector>
+# include "NodePool.hpp"
+
+namespace table
+{
+    /*
+    ** Allocator for bucket arrays. Large calloc blocks are mapped already
+    ** zeroed, and resize() leaves the elements alone, so a new array of
+    ** null heads costs nothing up front: its pages fault in one at a time
+    ** as the table touches them.
+    */
+    template<typename T>
+    struct ZeroedAllocator : std::allocator<T>
+    {
+        template<typename U>
+        struct rebind
+        {
+            typedef ZeroedAllocator<U> other;
+        };
+
+        ZeroedAllocator(void) = default;
+
+        template<typename U>
+        ZeroedAllocator(const ZeroedAllocator<U> &)
+        {
+        }
+
+        T *allocate(std::size_t n)
+        {
+            void *memory = std::calloc(n, sizeof(T));
+            if (memory == nullptr)
+                throw std::bad_alloc();
+            return static_cast<T *>(memory);
+        }
+
+        void deallocate(T *memory, std::size_t)
+        {
+            std::free(memory);
+        }
+
+        // value-initialization would write zeroes over the zeroed block
+        template<typename U>
+        void construct(U *)
+        {
+        }
+
+        template<typename U, typename... Args>
+        void construct(U *element, Args &&... args)
+        {
+            ::new(static_cast<void *>(element)) U(std::forward<Args>(args)...);
+        }
+    };
+
+    /*
+    ** Chained hash table from keys of type K to records of type V, for any
+    ** record type: bids here, courses or other records elsewhere. Records
+    ** are built in place by emplace() or moved in by insert(), and find()
+    ** hands back a pointer into the table instead of a copy, so neither
+    ** direction copies the record's strings.
+    **
+    ** Hash and Eq may be transparent (take a string_view for string keys,
+    ** std::equal_to<> compares a string with a string_view), in which case
+    ** find() and erase() accept any type they accept without building a K.
+    **
+    ** Keys are unique: inserting a key already there keeps the record
+    ** already there. Nodes come from a NodePool and keep their hash, so
+    ** they are relinked without hashing again. Pointers to records stay
+    ** valid until the record is erased.
+    **
+    ** The table grows once it holds more than MAX_LOAD_FACTOR records per
+    ** bucket. Growing doesn't rehash everything at once: the old buckets
+    ** are kept and every insert and erase relinks the nodes of a few of
+    ** them, so no single call pays for the whole table. Lookups never
+    ** change the table, so readers can share it under one lock; writers
+    ** call finishMigration() after a batch of inserts.
+    */
+    template<typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<>>
+    class HashTable
+    {
+
+    private:
+        struct Node
+        {
+            K key;
+            V value;
+            std::size_t hash;
+            Node *next;
+
+            // key is declared first, so it is built before args are moved from
+            template<typename KK, typename... Args>
+            Node(KK &&aKey, std::size_t aHash, Args &&... args) :
+                    key(std::forward<KK>(aKey)), value(std::forward<Args>(args)...), hash(aHash), next(nullptr)
+            {
+            }
+        };
+
+        typedef std::vector<Node *, ZeroedAllocator<Node *>> Buckets;
+
+    public:
+        // records per bucket that triggers growth
+        static constexpr double MAX_LOAD_FACTOR = 1.0;
+
+        // old buckets moved to the new array per insert or erase while growing
+        static const std::size_t MIGRATE_STEP = 4;
+
+        explicit HashTable(std::size_t buckets = 179, const Hash &hash = Hash(), const Eq &equal = Eq()) :
+                _migrated(0), _size(0), _hash(hash), _equal(equal)
+        {
+            _buckets.resize(buckets > 0 ? buckets : 1);
+        }
+
+        HashTable(const HashTable &) = delete;
+        HashTable &operator=(const HashTable &) = delete;
+
+    public:
+        /*
+        ** Builds the record from args in the table. Returns the record
+        ** under key and whether it was added, false when the key was
+        ** already there (args are then left alone).
+        */
+        template<typename... Args>
+        std::pair<V *, bool> emplace(const K &key, Args &&... args)
+        {
+            return emplaceHashed(_hash(key), key, std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        std::pair<V *, bool> emplace(K &&key, Args &&... args)
+        {
+            std::size_t hash = _hash(key);
+            return emplaceHashed(hash, std::move(key), std::forward<Args>(args)...);
+        }
+
+        std::pair<V *, bool> insert(const K &key, V &&value)
+        {
+            return emplace(key, std::move(value));
+        }
+
+        std::pair<V *, bool> insert(K &&key, V &&value)
+        {
+            return emplace(std::move(key), std::move(value));
+        }
+
+        /*
+        ** emplace() for a key already hashed with hashKey(), so a caller
+        ** that needs the hash for itself or prefetched its bucket doesn't
+        ** hash the key twice. The key is forwarded into the node.
+        */
+        template<typename KK, typename... Args>
+        std::pair<V *, bool> emplaceHashed(std::size_t hash, KK &&key, Args &&... args)
+        {
+            Node *found = lookup(key, hash);
+
+            if (found != nullptr)
+                return {&found->value, false};
+
+            migrate(MIGRATE_STEP);
+            reserve(_size + 1);
+
+            Node *node = _pool.create(std::forward<KK>(key), hash, std::forward<Args>(args)...);
+            link(_buckets[hash % _buckets.size()], node);
+            _size++;
+            return {&node->value, true};
+        }
+
+        template<typename Q>
+        V *find(const Q &key)
+        {
+            return findHashed(_hash(key), key);
+        }
+
+        template<typename Q>
+        const V *find(const Q &key) const
+        {
+            return findHashed(_hash(key), key);
+        }
+
+        template<typename Q>
+        V *findHashed(std::size_t hash, const Q &key)
+        {
+            Node *node = lookup(key, hash);
+            return (node != nullptr) ? &node->value : nullptr;
+        }
+
+        template<typename Q>
+        const V *findHashed(std::size_t hash, const Q &key) const
+        {
+            Node *node = lookup(key, hash);
+            return (node != nullptr) ? &node->value : nullptr;
+        }
+
+        template<typename Q>
+        bool erase(const Q &key)
+        {
+            std::size_t hash = _hash(key);
+
+            migrate(MIGRATE_STEP);
+
+            // an old bucket past the migration cursor may still hold it
+            if (!_oldBuckets.empty())
+            {
+                std::size_t old = hash % _oldBuckets.size();
+                if (old >= _migrated && unlink(_oldBuckets[old], key, hash))
+                    return true;
+            }
+            return unlink(_buckets[hash % _buckets.size()], key, hash);
+        }
+
+        /*
+        ** Calls visit(key, record) for every record, bucket by bucket,
+        ** old buckets still to migrate first.
+        */
+        template<typename Visit>
+        void forEach(Visit visit) const
+        {
+            for (const Buckets *buckets : {&_oldBuckets, &_buckets})
+                for (Node *bucket : *buckets)
+                    for (Node *node = bucket; node != nullptr; node = node->next)
+                        visit(static_cast<const K &>(node->key), static_cast<const V &>(node->value));
+        }
+
+        /*
+        ** Calls visit(length, arrayBuckets) for every bucket a lookup may
+        ** still walk: all the current buckets and, while growing, the old
+        ** ones not migrated yet. arrayBuckets is the size of the array the
+        ** bucket is in, the one a miss picks a bucket from.
+        */
+        template<typename Visit>
+        void forEachChain(Visit visit) const
+        {
+            for (const Buckets *buckets : {&_oldBuckets, &_buckets})
+            {
+                std::size_t first = (buckets == &_oldBuckets) ? _migrated : 0;
+                for (std::size_t i = first; i < buckets->size(); i++)
+                {
+                    std::size_t length = 0;
+                    for (Node *node = (*buckets)[i]; node != nullptr; node = node->next)
+                        length++;
+                    visit(length, buckets->size());
+                }
+            }
+        }
+
+        /*
+        ** Grows the table now, if needed, so that it holds records
+        ** without growing again.
+        */
+        void reserve(std::size_t records)
+        {
+            if (records > _buckets.size() * MAX_LOAD_FACTOR)
+                grow(static_cast<std::size_t>(records / MAX_LOAD_FACTOR));
+        }
+
+        /*
+        ** Moves every old bucket still waiting. Lookups never migrate, so a
+        ** table that stops changing partway through growing would keep
+        ** walking two arrays; loaders call this once they are done.
+        */
+        void finishMigration(void)
+        {
+            migrate(_oldBuckets.size());
+        }
+
+        template<typename Q>
+        std::size_t hashKey(const Q &key) const
+        {
+            return _hash(key);
+        }
+
+        /*
+        ** Starts loading the bucket slot of a hash, then, once that is
+        ** in, the head of its chain. A batch prefetches all its slots
+        ** before all its heads, so their cache misses overlap. Only the
+        ** current buckets are prefetched, which is where new keys go.
+        */
+        void prefetchBucket(std::size_t hash) const
+        {
+            prefetch(&_buckets[hash % _buckets.size()]);
+        }
+
+        void prefetchChain(std::size_t hash) const
+        {
+            prefetch(_buckets[hash % _buckets.size()]);
+        }
+
+        void clear(void)
+        {
+            _pool.clear();
+            Buckets().swap(_oldBuckets);
+            _migrated = 0;
+            _buckets.assign(_buckets.size(), nullptr);
+            _size = 0;
+        }
+
+        std::size_t size(void) const
+        {
+            return _size;
+        }
+
+        std::size_t buckets(void) const
+        {
+            return _buckets.size();
+        }
+
+        // old buckets still to migrate, 0 unless the table is growing
+        std::size_t pendingBuckets(void) const
+        {
+            return _oldBuckets.empty() ? 0 : _oldBuckets.size() - _migrated;
+        }
+
+        double loadFactor(void) const
+        {
+            return _size * 1.0 / _buckets.size();
+        }
+
+        std::size_t bucketBytes(void) const
+        {
+            return (_buckets.capacity() + _oldBuckets.capacity()) * sizeof(Node *);
+        }
+
+        std::size_t nodeBytes(void) const
+        {
+            return _pool.capacity();
+        }
+
+    private:
+        static void prefetch(const void *address)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+#else
+            (void) address;
+#endif
+        }
+
+        template<typename Q>
+        Node *lookup(const Q &key, std::size_t hash) const
+        {
+            if (!_oldBuckets.empty())
+            {
+                std::size_t old = hash % _oldBuckets.size();
+                if (old >= _migrated)
+                    for (Node *node = _oldBuckets[old]; node != nullptr; node = node->next)
+                        if (node->hash == hash && _equal(node->key, key))
+                            return node;
+            }
+            for (Node *node = _buckets[hash % _buckets.size()]; node != nullptr; node = node->next)
+                if (node->hash == hash && _equal(node->key, key))
+                    return node;
+            return nullptr;
+        }
+
+        static void link(Node *&bucket, Node *node)
+        {
+            node->next = bucket;
+            bucket = node;
+        }
+
+        template<typename Q>
+        bool unlink(Node *&bucket, const Q &key, std::size_t hash)
+        {
+            for (Node **link = &bucket; *link != nullptr; link = &(*link)->next)
+            {
+                Node *node = *link;
+                if (node->hash == hash && _equal(node->key, key))
+                {
+                    *link = node->next;
+                    _pool.destroy(node);
+                    _size--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static std::size_t nextPrime(std::size_t n)
+        {
+            for (;; n++)
+            {
+                bool prime = n > 1;
+                for (std::size_t d = 2; d * d <= n && prime; d++)
+                    prime = n % d != 0;
+                if (prime)
+                    return n;
+            }
+        }
+
+        /*
+        ** Starts moving to an array of at least twice the buckets, or
+        ** minBuckets if that is more. The current buckets become the old
+        ** ones and are drained by migrate().
+        */
+        void grow(std::size_t minBuckets)
+        {
+            // growth can only outpace migration with a tiny MIGRATE_STEP, finish it first
+            migrate(_oldBuckets.size());
+
+            _oldBuckets.swap(_buckets);
+            _migrated = 0;
+            _buckets.clear();
+            _buckets.resize(nextPrime(std::max(minBuckets, _oldBuckets.size() * 2 + 1)));
+        }
+
+        /*
+        ** Moves the nodes of up to count old buckets into the current
+        ** array. Buckets go in index order, so an old bucket below the
+        ** cursor is empty.
+        */
+        void migrate(std::size_t count)
+        {
+            for (; count > 0 && _migrated < _oldBuckets.size(); count--, _migrated++)
+            {
+                Node *node = _oldBuckets[_migrated];
+                _oldBuckets[_migrated] = nullptr;
+
+                while (node != nullptr)
+                {
+                    Node *next = node->next;
+                    link(_buckets[node->hash % _buckets.size()], node);
+                    node = next;
+                }
+            }
+
+            // drained, the old buckets are released
+            if (_migrated == _oldBuckets.size() && !_oldBuckets.empty())
+            {
+                Buckets().swap(_oldBuckets);
+                _migrated = 0;
+            }
+        }
+
+    private:
+        pool::NodePool<Node> _pool;
+        Buckets _buckets;
+        Buckets _oldBuckets;
+        std::size_t _migrated;
+        std::size_t _size;
+        Hash _hash;
+        Eq _equal;
+    };
+}
+
+#endif //HASHTABLE_HASHMAP_HPP
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <limits>
+#include "PerfectHash.hpp"
+
+namespace mph {
+
+    // a build this unlucky means the key hashes themselves collide
+    static const unsigned int MAX_ATTEMPTS = 16;
+
+    static inline std::uint64_t finalize(std::uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    Function::Function(void) : _seed(0), _keys(0), _tableSize(1), _pilots(1, 0), _attempts(0) {}
+
+    Function::~Function(void) {}
+
+    /*
+    ** Builds the function for the given key hashes, which must be
+    ** distinct. A seed that leaves some bucket without a pilot, or makes
+    ** two keys collide, is replaced and the build starts over.
+    */
+    void Function::build(const std::vector<std::uint64_t> &hashes)
+    {
+        if (hashes.size() > std::numeric_limits<std::uint32_t>::max())
+            throw Error("too many keys");
+
+        for (_attempts = 1; _attempts <= MAX_ATTEMPTS; _attempts++)
+        {
+            _seed = finalize(_attempts);
+            if (tryBuild(hashes))
+                return;
+        }
+        throw Error("no seed places every key, are the hashes distinct?");
+    }
+
+    std::uint64_t Function::mix(std::uint64_t hash) const
+    {
+        return finalize(hash ^ _seed);
+    }
+
+    std::size_t Function::bucket(std::uint64_t mixed) const
+    {
+        return static_cast<std::size_t>(((mixed >> 32) * _pilots.size()) >> 32);
+    }
+
+    std::size_t Function::position(std::uint64_t mixed, std::uint16_t pilot) const
+    {
+        return static_cast<std::size_t>((mixed ^ finalize(pilot + 1)) % _tableSize);
+    }
+
+    bool Function::tryBuild(const std::vector<std::uint64_t> &hashes)
+    {
+        _keys = hashes.size();
+        _tableSize = std::max<std::size_t>(1, static_cast<std::size_t>(_keys / LOAD_FACTOR) + 1);
+        _pilots.assign(std::max<std::size_t>(1, (_keys + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET), 0);
+        _remap.clear();
+
+        // keys grouped by bucket with a counting sort
+        std::vector<std::uint64_t> mixed(_keys);
+        std::vector<std::uint32_t> start(_pilots.size() + 1, 0);
+        for (std::size_t i = 0; i < _keys; i++)
+        {
+            mixed[i] = mix(hashes[i]);
+            start[bucket(mixed[i]) + 1]++;
+        }
+        for (std::size_t b = 0; b < _pilots.size(); b++)
+            start[b + 1] += start[b];
+        std::vector<std::uint64_t> grouped(_keys);
+        std::vector<std::uint32_t> fill(start.begin(), start.end() - 1);
+        for (std::size_t i = 0; i < _keys; i++)
+            grouped[fill[bucket(mixed[i])]++] = mixed[i];
+
+        // largest buckets first, while the table is still empty enough
+        std::vector<std::uint32_t> order(_pilots.size());
+        for (std::size_t b = 0; b < order.size(); b++)
+            order[b] = b;
+        std::stable_sort(order.begin(), order.end(), [&start](std::uint32_t a, std::uint32_t b) {
+            return start[a + 1] - start[a] > start[b + 1] - start[b];
+        });
+
+        std::vector<bool> taken(_tableSize, false);
+        std::vector<std::size_t> positions;
+        for (std::uint32_t b : order)
+        {
+            std::size_t first = start[b];
+            std::size_t count = start[b + 1] - first;
+            if (count == 0)
+                break;
+
+            bool placed = false;
+            for (std::uint32_t pilot = 0; pilot <= std::numeric_limits<std::uint16_t>::max() && !placed; pilot++)
+            {
+                positions.clear();
+                placed = true;
+                for (std::size_t k = 0; k < count && placed; k++)
+                {
+                    std::size_t p = position(grouped[first + k], static_cast<std::uint16_t>(pilot));
+                    placed = !taken[p] && std::find(positions.begin(), positions.end(), p) == positions.end();
+                    positions.push_back(p);
+                }
+                if (placed)
+                {
+                    _pilots[b] = static_cast<std::uint16_t>(pilot);
+                    for (std::size_t p : positions)
+                        taken[p] = true;
+                }
+            }
+            if (!placed)
+                return false;
+        }
+
+        // every key placed past the end takes one of the holes below it
+        std::size_t hole = 0;
+        _remap.assign(_tableSize - _keys, 0);
+        for (std::size_t p = _keys; p < _tableSize; p++)
+        {
+            if (!taken[p])
+                continue;
+            while (taken[hole])
+                hole++;
+            _remap[p - _keys] = static_cast<std::uint32_t>(hole++);
+        }
+        return true;
+    }
+
+    std::size_t Function::operator()(std::uint64_t hash) const
+    {
+        std::uint64_t mixed = mix(hash);
+        std::size_t p = position(mixed, _pilots[bucket(mixed)]);
+
+        return (p < _keys) ? p : _remap[p - _keys];
+    }
+
+    std::size_t Function::size(void) const
+    {
+        return _keys;
+    }
+
+    std::size_t Function::bytes(void) const
+    {
+        return _pilots.size() * sizeof(std::uint16_t) + _remap.size() * sizeof(std::uint32_t);
+    }
+
+    /*
+    ** Seeds tried by the last build, 1 when the first one worked.
+    */
+    unsigned int Function::attempts(void) const
+    {
+        return _attempts;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef HASHTABLE_PERFECTHASH_HPP
+#define HASHTABLE_PERFECTHASH_HPP
+
+# include <cstddef>
+# include <cstdint>
+# include <stdexcept>
+# include <string>
+# include <vector>
+
+/*
+** Minimal perfect hash function over a fixed set of 64-bit key hashes,
+** built the CHD/PTHash way. Keys are split into buckets of about five;
+** buckets are placed largest first, each with the first "pilot" value
+** that sends all of its keys to free positions of a table 1% larger
+** than the key count. The few keys that land past the end are remapped
+** into the holes left below it, so every key gets its own index in
+** [0, size()).
+**
+** A lookup reads one pilot and at most one remap entry. A hash that was
+** not in the set still maps to some index; the caller has to check the
+** key stored there.
+*/
+namespace mph
+{
+    class Error : public std::runtime_error
+    {
+
+    public:
+        Error(const std::string &msg):
+                std::runtime_error(std::string("PerfectHash : ").append(msg))
+        {
+        }
+    };
+
+    const unsigned int KEYS_PER_BUCKET = 5;
+    const double LOAD_FACTOR = 0.99;
+
+    class Function
+    {
+
+    public:
+        Function(void);
+        ~Function(void);
+
+    public:
+        void build(const std::vector<std::uint64_t> &hashes);
+        std::size_t operator()(std::uint64_t hash) const;
+        std::size_t size(void) const;
+        std::size_t bytes(void) const;
+        unsigned int attempts(void) const;
+
+    private:
+        bool tryBuild(const std::vector<std::uint64_t> &hashes);
+        std::uint64_t mix(std::uint64_t hash) const;
+        std::size_t bucket(std::uint64_t mixed) const;
+        std::size_t position(std::uint64_t mixed, std::uint16_t pilot) const;
+
+    private:
+        std::uint64_t _seed;
+        std::size_t _keys;
+        std::size_t _tableSize;
+        std::vector<std::uint16_t> _pilots;
+        std::vector<std::uint32_t> _remap;
+        unsigned int _attempts;
+    };
+}
+
+#endif //HASHTABLE_PERFECTHASH_HPP
@@ -7,12 +7,37 @@
 //============================================================================
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <climits>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <shared_mutex>
 #include <string> // atoi
+#include <string_view>
+#include <thread>
 #include <time.h>
-
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASHTABLE_SSE2 1
+#include <emmintrin.h>
+#else
+#define HASHTABLE_SSE2 0
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "BidSnapshot.hpp"
+#include "BloomFilter.hpp"
 #include "CSVparser.hpp"
+#include "HashMap.hpp"
+#include "NodePool.hpp"
+#include "PerfectHash.hpp"
 
 using namespace std;
 
@@ -22,8 +47,14 @@ using namespace std;
 
 const unsigned int DEFAULT_SIZE = 179;
 
-// forward declarations
-double strToDouble(string str, char ch);
+// Number of bids in the synthetic set the table benchmark builds
+const unsigned int SYNTHETIC_BIDS = 10000000;
+
+// Bids hashed and prefetched together by InsertBatch
+const unsigned int INSERT_BATCH = 16;
+
+// Rows loadBids and loadSnapshot collect before handing them to InsertBatch
+const unsigned int LOAD_BATCH = 256;
 
 // define a structure to hold bid information
 struct Bid {
@@ -36,99 +67,1048 @@ struct Bid {
     }
 };
 
+//============================================================================
+// Bid id hashing
+//============================================================================
+
+/**
+ * Reads 8 or 4 bytes of a key, whatever its alignment
+ */
+static inline uint64_t read64(const char* bytes) {
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint64_t read32(const char* bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+/**
+ * Multiplies two 64-bit values to 128 bits and folds the halves
+ * together, the mixing step of wyhash.
+ */
+static inline uint64_t foldMultiply(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    uint64_t aHigh = a >> 32, aLow = a & 0xffffffff;
+    uint64_t bHigh = b >> 32, bLow = b & 0xffffffff;
+    uint64_t middle = aHigh * bLow + ((aLow * bLow) >> 32);
+    uint64_t cross = aLow * bHigh + (middle & 0xffffffff);
+    uint64_t high = aHigh * bHigh + (middle >> 32) + (cross >> 32);
+    return (a * b) ^ high;
+#endif
+}
+
+/**
+ * Hashes a bid id of any characters, in the style of wyhash: ids of
+ * up to 16 bytes are read as two overlapping words and mixed with two
+ * multiplies, with no per-character loop and no conversion to a
+ * number. Every bit of the result depends on every byte of the id.
+ *
+ * @param bidId The bid id to hash
+ * @return The 64-bit hash
+ */
+uint64_t hashBidId(string_view bidId) {
+    const uint64_t secret0 = 0xa0761d6478bd642fULL;
+    const uint64_t secret1 = 0xe7037ed1a0b428dbULL;
+    const char* bytes = bidId.data();
+    size_t length = bidId.size();
+    uint64_t seed = secret0;
+    uint64_t a = 0;
+    uint64_t b = 0;
+
+    for (; length > 16; bytes += 16, length -= 16) {
+        seed = foldMultiply(read64(bytes) ^ secret1, read64(bytes + 8) ^ seed);
+    }
+
+    if (length >= 8) {
+        a = read64(bytes);
+        b = read64(bytes + length - 8);
+    } else if (length >= 4) {
+        a = read32(bytes);
+        b = read32(bytes + length - 4);
+    } else if (length > 0) {
+        a = (static_cast<uint64_t>(static_cast<unsigned char>(bytes[0])) << 16)
+            | (static_cast<uint64_t>(static_cast<unsigned char>(bytes[length / 2])) << 8)
+            | static_cast<unsigned char>(bytes[length - 1]);
+    }
+
+    return foldMultiply(secret1 ^ bidId.size(), foldMultiply(a ^ secret1, b ^ seed));
+}
+
+/**
+ * hashBidId as a hash functor. It takes a string_view, so a table
+ * keyed by string can be searched with a view without building one.
+ */
+struct BidIdHash {
+    size_t operator()(string_view bidId) const {
+        return hashBidId(bidId);
+    }
+};
+
+/**
+ * Asks the CPU to start loading the cache line at an address. It never
+ * faults, so a null or stale address is harmless.
+ */
+static inline void prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#elif HASHTABLE_SSE2
+    _mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#else
+    (void) address;
+#endif
+}
+
 //============================================================================
 // Hash Table class definition
 //============================================================================
 
+class FrozenHashTable;
+
+/**
+ * Define a structure to hold a snapshot of how a chained table is
+ * laid out: how full its buckets are, how long its chains run, what
+ * a lookup walks through, and what the whole table costs in memory.
+ * Probe counts are bids compared by Search: a bid found at the Nth
+ * node of its chain takes N probes, a miss walks its whole chain.
+ */
+struct TableStats {
+    unsigned int buckets = 0;
+    unsigned int usedBuckets = 0;
+    unsigned int bids = 0;
+    double loadFactor = 0.0;
+
+    // Buckets of each chain length, index 0 counting empty buckets
+    vector<unsigned int> chainLengths;
+
+    double hitProbes = 0.0;
+    unsigned int maxHitProbes = 0;
+    double missProbes = 0.0;
+    unsigned int maxMissProbes = 0;
+
+    // Old buckets still to migrate, 0 unless the table is growing
+    unsigned int pendingBuckets = 0;
+
+    size_t bucketBytes = 0;
+    size_t nodeBytes = 0;
+    size_t stringBytes = 0;
+    size_t filterBytes = 0;
+
+    size_t TotalBytes() const {
+        return bucketBytes + nodeBytes + stringBytes + filterBytes;
+    }
+};
+
 /**
  * Define a class containing data members and methods to
  * implement a hash table with chaining.
+ *
+ * The bids are held by id in the generic chained table of HashMap.hpp,
+ * which grows incrementally: once it holds more than MAX_LOAD_FACTOR
+ * bids per bucket, every Insert and Remove relinks the nodes of a few
+ * old buckets, so no single call pays for the whole table. Search
+ * never changes the table, so readers can share it under one lock;
+ * InsertBatch and Freeze finish any growth left, since loads are
+ * followed by searches. Ids are unique, inserting an id already there keeps the bid that
+ * was there, the one Search would have found.
  */
 class HashTable {
 
 private:
-    // Define structures to hold bids
-    struct Node {
-        Bid bid;
-        unsigned int key;
-        Node *next;
-
-        // default constructor
-        Node() {
-            key = UINT_MAX;
-            next = nullptr;
+    typedef table::HashTable<string, Bid, BidIdHash> Bids;
+
+    // Every bid, keyed by its id
+    Bids bids;
+
+    // Optional filter that answers most misses without touching a bucket
+    bloom::Filter filter;
+    bool filtering = false;
+    unsigned int removedSinceBuild = 0;
+
+    void remember(uint64_t hashValue);
+    void rebuildFilter();
+
+public:
+    HashTable();
+    HashTable(unsigned int size);
+    virtual ~HashTable();
+    void Insert(Bid bid);
+    void InsertBatch(Bid* batchBids, unsigned int bidCount);
+    void ForEach(const function<void(const Bid &)> &visit);
+    void PrintAll();
+    void Remove(string_view bidId);
+    const Bid* Find(string_view bidId) const;
+    Bid Search(string_view bidId) const;
+    unsigned int Size() const;
+    double LoadFactor() const;
+    TableStats Stats() const;
+    void EnableFilter();
+    void DisableFilter();
+    bool Filtering() const;
+    const bloom::Filter &GetFilter() const;
+    FrozenHashTable Freeze();
+
+};
+
+/**
+ * Default constructor
+ */
+HashTable::HashTable() : bids(DEFAULT_SIZE) {
+}
+
+/**
+ * Constructor for specifying size of the table
+ * Use to improve efficiency of hashing algorithm
+ * by reducing collisions without wasting memory.
+ */
+HashTable::HashTable(unsigned int size) : bids(size) {
+}
+
+/**
+ * Destructor
+ */
+HashTable::~HashTable() {
+    // The node pool releases every node in whole blocks
+}
+
+/**
+ * Insert a bid
+ *
+ * @param bid The bid to insert
+ */
+void HashTable::Insert(Bid bid) {
+    // The id is hashed once for the table and the filter
+    uint64_t hashValue = hashBidId(bid.bidId);
+
+    // The key is copied from the id before the bid is moved in
+    if (bids.emplaceHashed(hashValue, bid.bidId, std::move(bid)).second) {
+        remember(hashValue);
+    }
+}
+
+/**
+ * Insert a run of bids, moving them out of the array. The bids are
+ * taken INSERT_BATCH at a time: all their buckets are hashed and
+ * prefetched, then their chain heads, and only then are they linked
+ * in, so the cache misses of a batch overlap instead of coming one
+ * after the other.
+ *
+ * @param batchBids The bids to insert
+ * @param bidCount The number of bids
+ */
+void HashTable::InsertBatch(Bid* batchBids, unsigned int bidCount) {
+    uint64_t hashes[INSERT_BATCH];
+
+    for (unsigned int start = 0; start < bidCount; start += INSERT_BATCH) {
+        unsigned int batch = min(INSERT_BATCH, bidCount - start);
+        Bid* batchStart = batchBids + start;
+
+        // Grown first, so the buckets prefetched are the ones the bids go into
+        bids.reserve(bids.size() + batch);
+
+        for (unsigned int i = 0; i < batch; i++) {
+            hashes[i] = hashBidId(batchStart[i].bidId);
+            bids.prefetchBucket(hashes[i]);
+        }
+        for (unsigned int i = 0; i < batch; i++) {
+            bids.prefetchChain(hashes[i]);
         }
+        for (unsigned int i = 0; i < batch; i++) {
+            if (bids.emplaceHashed(hashes[i], batchStart[i].bidId, std::move(batchStart[i])).second) {
+                remember(hashes[i]);
+            }
+        }
+    }
 
-        // initialize with a bid
-        Node(Bid aBid) : Node() {
-            bid = aBid;
+    // Searches never migrate, so a table that is only read after
+    // this batch doesn't keep two bucket arrays to look through
+    bids.finishMigration();
+}
+
+/**
+ * Visit every bid in the table, bucket by bucket
+ *
+ * @param visit Function called with each bid
+ */
+void HashTable::ForEach(const function<void(const Bid &)> &visit) {
+    bids.forEach([&visit](const string &, const Bid &bid) {
+        visit(bid);
+    });
+}
+
+/**
+ * Print all bids
+ */
+void HashTable::PrintAll() {
+    bids.forEach([this](const string &bidId, const Bid &bid) {
+        // Each bid is printed after the bucket its id hashes to
+        cout << hashBidId(bidId) % bids.buckets() << ": " << bid.bidId << " | "
+             << bid.title << " | " << bid.amount << " | "
+             << bid.fund << endl;
+    });
+}
+
+/**
+ * Remove a bid
+ *
+ * @param bidId The bid id to search for
+ */
+void HashTable::Remove(string_view bidId) {
+    // The filter can't forget the id, it only costs false positives
+    // until enough have gone that a rebuild is worth it
+    if (bids.erase(bidId) && filtering && ++removedSinceBuild * 4 > bids.size()) {
+        rebuildFilter();
+    }
+}
+
+/**
+ * Find the bid with the specified bidId, without copying it
+ *
+ * @param bidId The bid id to search for
+ * @return The bid in the table, or nullptr when it isn't found. It
+ *         stays valid until the bid is removed.
+ */
+const Bid* HashTable::Find(string_view bidId) const {
+    // The id is hashed once for the filter and the table
+    uint64_t hashValue = hashBidId(bidId);
+
+    // A definite miss costs one cache line of the filter
+    if (filtering && !filter.mayContain(hashValue)) {
+        return nullptr;
+    }
+    return bids.findHashed(hashValue, bidId);
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ * @return A copy of the bid, or an empty bid when it isn't found
+ */
+Bid HashTable::Search(string_view bidId) const {
+    const Bid* bid = Find(bidId);
+    if (bid == nullptr) {
+        return Bid();
+    }
+    return *bid;
+}
+
+/**
+ * @return The number of bids in the table
+ */
+unsigned int HashTable::Size() const {
+    return bids.size();
+}
+
+/**
+ * @return The average number of bids per bucket
+ */
+double HashTable::LoadFactor() const {
+    return bids.loadFactor();
+}
+
+/**
+ * Heap bytes behind a string, 0 when it fits in the string itself
+ *
+ * @param text The string to measure
+ */
+static size_t heapBytes(const string &text) {
+    const char* inside = reinterpret_cast<const char *>(&text);
+    if (text.data() >= inside && text.data() < inside + sizeof(text)) {
+        return 0;
+    }
+    return text.capacity() + 1;
+}
+
+/**
+ * Walks every bucket, old ones still to migrate included, and
+ * measures the chains and the memory behind them.
+ *
+ * @return The table's statistics
+ */
+TableStats HashTable::Stats() const {
+    TableStats stats;
+    unsigned long long hitTotal = 0;
+    unsigned int longest = 0;
+    unsigned int oldLongest = 0;
+
+    stats.bids = bids.size();
+    stats.buckets = bids.buckets();
+    stats.loadFactor = LoadFactor();
+    stats.pendingBuckets = bids.pendingBuckets();
+
+    bids.forEachChain([&](size_t length, size_t arrayBuckets) {
+        // Old buckets still to migrate are in an array of another size
+        unsigned int &arrayLongest = (arrayBuckets == stats.buckets) ? longest : oldLongest;
+
+        // The Nth bid of a chain takes N probes, a miss walks one
+        // chain of each array it still searches
+        hitTotal += length * (length + 1) / 2;
+        stats.missProbes += length * 1.0 / arrayBuckets;
+        arrayLongest = max(arrayLongest, static_cast<unsigned int>(length));
+
+        if (length >= stats.chainLengths.size()) {
+            stats.chainLengths.resize(length + 1, 0);
+        }
+        stats.chainLengths[length]++;
+        if (length > 0) {
+            stats.usedBuckets++;
         }
+    });
+    stats.maxHitProbes = max(longest, oldLongest);
+    stats.maxMissProbes = longest + oldLongest;
+    if (stats.bids > 0) {
+        stats.hitProbes = hitTotal * 1.0 / stats.bids;
+    }
+
+    bids.forEach([&stats](const string &bidId, const Bid &bid) {
+        stats.stringBytes += heapBytes(bidId) + heapBytes(bid.bidId) + heapBytes(bid.title)
+                             + heapBytes(bid.fund);
+    });
+    stats.bucketBytes = bids.bucketBytes();
+    stats.nodeBytes = bids.nodeBytes();
+    stats.filterBytes = filtering ? filter.bytes() : 0;
+    return stats;
+}
+
+/**
+ * Adds a new bid's hash to the filter, rebuilding the filter
+ * at twice the size once it holds as many keys as it was sized for.
+ *
+ * @param hashValue The hash of the new bid's id
+ */
+void HashTable::remember(uint64_t hashValue) {
+    if (!filtering) {
+        return;
+    }
+    if (filter.keys() >= filter.capacity()) {
+        rebuildFilter();
+    } else {
+        filter.add(hashValue);
+    }
+}
+
+/**
+ * Refills the filter from every bid in the table, with room
+ * for the table to double before it is rebuilt again.
+ */
+void HashTable::rebuildFilter() {
+    filter.reset(max<size_t>(bids.size() * 2, DEFAULT_SIZE));
+    removedSinceBuild = 0;
+    bids.forEach([this](const string &bidId, const Bid &) {
+        filter.add(hashBidId(bidId));
+    });
+}
+
+/**
+ * Puts a Bloom filter in front of Search, built from the bids
+ * already in the table and kept up to date from then on.
+ */
+void HashTable::EnableFilter() {
+    filtering = true;
+    rebuildFilter();
+}
+
+/**
+ * Drops the filter, Search walks the chains for every id again
+ */
+void HashTable::DisableFilter() {
+    filtering = false;
+    filter.reset(0);
+}
+
+/**
+ * @return Whether Search goes through the filter
+ */
+bool HashTable::Filtering() const {
+    return filtering;
+}
+
+/**
+ * @return The filter, for its size and false positive rate
+ */
+const bloom::Filter &HashTable::GetFilter() const {
+    return filter;
+}
+
+/**
+ * Index of the lowest set bit of a non-zero mask
+ */
+static inline unsigned int lowestBit(unsigned int mask) {
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward(&bit, mask);
+    return bit;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+//============================================================================
+// Open addressing hash table class definition
+//============================================================================
+
+/**
+ * Define a class containing data members and methods to
+ * implement a hash table with open addressing, laid out like
+ * a Swiss table. Bids live inline in one slot array. A parallel
+ * array of control bytes marks each slot empty, deleted, or full
+ * with the low 7 bits of its hash, so a lookup checks 16 slots
+ * with one compare and only touches a bid when those bits match.
+ */
+class FlatHashTable {
+
+private:
+    static const unsigned int GROUP_SIZE = 16;
+
+    // Control byte values, full slots hold 0..127
+    static constexpr signed char EMPTY = -128;
+    static constexpr signed char DELETED = -2;
+
+    vector<signed char> controls;
+    vector<Bid> slots;
 
-        // initialize with a bid and a key
-        Node(Bid aBid, unsigned int aKey) : Node(aBid) {
-            key = aKey;
+    unsigned int groupMask = 0; // number of groups minus one, always a power of two minus one
+    unsigned int count = 0;
+    unsigned int tombstones = 0;
+
+    static uint64_t hash(string_view bidId);
+    unsigned int match(unsigned int group, signed char value) const;
+    unsigned int matchFree(unsigned int group) const;
+    bool find(string_view bidId, uint64_t hashValue, unsigned int &slot) const;
+    void insert(Bid &&bid, uint64_t hashValue);
+    void rehash(unsigned int groups);
+
+public:
+    FlatHashTable();
+    FlatHashTable(unsigned int size);
+    void Insert(Bid bid);
+    void InsertBatch(Bid* bids, unsigned int bidCount);
+    void ForEach(const function<void(const Bid &)> &visit);
+    void PrintAll();
+    void Remove(string_view bidId);
+    Bid Search(string_view bidId);
+    unsigned int Size() const;
+};
+
+/**
+ * Default constructor
+ */
+FlatHashTable::FlatHashTable() : FlatHashTable(DEFAULT_SIZE) {
+}
+
+/**
+ * Constructor for specifying the number of bids the table
+ * should hold before it has to grow.
+ *
+ * @param size The expected number of bids
+ */
+FlatHashTable::FlatHashTable(unsigned int size) {
+    // Groups are a power of two so a hash masks straight to a group
+    unsigned int groups = 1;
+    while (groups * GROUP_SIZE * 7 / 8 < size) {
+        groups *= 2;
+    }
+    rehash(groups);
+}
+
+/**
+ * Calculate the 64-bit hash of a bid id. The low 7 bits are
+ * stored in the control byte, the rest pick the first group
+ * to probe.
+ *
+ * @param bidId The bid id to hash
+ * @return The calculated hash
+ */
+uint64_t FlatHashTable::hash(string_view bidId) {
+    return hashBidId(bidId);
+}
+
+/**
+ * Compares the 16 control bytes of a group against a value
+ *
+ * @param group The group to check
+ * @param value The control byte to look for
+ * @return A bitmask with bit i set when slot i of the group matches
+ */
+unsigned int FlatHashTable::match(unsigned int group, signed char value) const {
+    const signed char* bytes = controls.data() + group * GROUP_SIZE;
+#if HASHTABLE_SSE2
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+    return static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value))));
+#else
+    unsigned int mask = 0;
+    for (unsigned int i = 0; i < GROUP_SIZE; i++) {
+        if (bytes[i] == value) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Finds the empty or deleted slots of a group
+ *
+ * @param group The group to check
+ * @return A bitmask with bit i set when slot i of the group can take a bid
+ */
+unsigned int FlatHashTable::matchFree(unsigned int group) const {
+    const signed char* bytes = controls.data() + group * GROUP_SIZE;
+#if HASHTABLE_SSE2
+    // EMPTY and DELETED are the only control bytes below -1
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+    return static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl)));
+#else
+    unsigned int mask = 0;
+    for (unsigned int i = 0; i < GROUP_SIZE; i++) {
+        if (bytes[i] < -1) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Probes group after group (triangular steps visit every group
+ * once) until the bid is found or a group with an empty slot ends
+ * the probe sequence.
+ *
+ * @param bidId The bid id to search for
+ * @param hashValue The hash of the bid id
+ * @param slot Set to the slot holding the bid when found
+ * @return Whether the bid is in the table
+ */
+bool FlatHashTable::find(string_view bidId, uint64_t hashValue, unsigned int &slot) const {
+    signed char tag = static_cast<signed char>(hashValue & 0x7F);
+    unsigned int group = static_cast<unsigned int>(hashValue >> 7) & groupMask;
+
+    for (unsigned int step = 1; step <= groupMask + 1; step++) {
+        for (unsigned int hits = match(group, tag); hits != 0; hits &= hits - 1) {
+            unsigned int candidate = group * GROUP_SIZE + lowestBit(hits);
+            if (slots[candidate].bidId == bidId) {
+                slot = candidate;
+                return true;
+            }
+        }
+        if (match(group, EMPTY) != 0) {
+            return false;
+        }
+        group = (group + step) & groupMask;
+    }
+    return false;
+}
+
+/**
+ * Moves every bid into a fresh set of groups, which also
+ * clears out the deleted markers.
+ *
+ * @param groups The new number of groups, a power of two
+ */
+void FlatHashTable::rehash(unsigned int groups) {
+    // Swaps in the empty arrays, the old ones are drained below
+    vector<signed char> oldControls(groups * GROUP_SIZE, EMPTY);
+    vector<Bid> oldSlots(groups * GROUP_SIZE);
+    oldControls.swap(controls);
+    oldSlots.swap(slots);
+    groupMask = groups - 1;
+    count = 0;
+    tombstones = 0;
+
+    for (unsigned int i = 0; i < oldControls.size(); i++) {
+        if (oldControls[i] >= 0) {
+            Insert(std::move(oldSlots[i]));
+        }
+    }
+}
+
+/**
+ * Insert a bid. A bid whose id is already in the
+ * table replaces the stored one.
+ *
+ * @param bid The bid to insert
+ */
+void FlatHashTable::Insert(Bid bid) {
+    uint64_t hashValue = hash(bid.bidId);
+    insert(std::move(bid), hashValue);
+}
+
+/**
+ * Insert a run of bids, moving them out of the array. The bids are
+ * taken INSERT_BATCH at a time: all their hashes are computed and the
+ * control groups they start probing at are prefetched before any of
+ * them is inserted.
+ *
+ * @param bids The bids to insert
+ * @param bidCount The number of bids
+ */
+void FlatHashTable::InsertBatch(Bid* bids, unsigned int bidCount) {
+    uint64_t hashes[INSERT_BATCH];
+
+    for (unsigned int start = 0; start < bidCount; start += INSERT_BATCH) {
+        unsigned int batch = min(INSERT_BATCH, bidCount - start);
+
+        for (unsigned int i = 0; i < batch; i++) {
+            hashes[i] = hash(bids[start + i].bidId);
+            unsigned int group = static_cast<unsigned int>(hashes[i] >> 7) & groupMask;
+            prefetch(controls.data() + group * GROUP_SIZE);
+        }
+
+        // A rehash partway through only wastes the rest of the prefetches
+        for (unsigned int i = 0; i < batch; i++) {
+            insert(std::move(bids[start + i]), hashes[i]);
+        }
+    }
+}
+
+/**
+ * Insert a bid whose hash is already known
+ *
+ * @param bid The bid to insert
+ * @param hashValue The hash of its id
+ */
+void FlatHashTable::insert(Bid &&bid, uint64_t hashValue) {
+    unsigned int slot;
+
+    // Ids are unique, the bid already there stays, as in the chained table
+    if (find(bid.bidId, hashValue, slot)) {
+        return;
+    }
+
+    // Keeps at least one slot in eight empty so misses stop early,
+    // rehashing in place when deleted markers are what fill it up
+    unsigned int capacity = (groupMask + 1) * GROUP_SIZE;
+    if ((count + tombstones + 1) * 8 > capacity * 7) {
+        rehash((count + 1) * 16 > capacity * 7 ? (groupMask + 1) * 2 : groupMask + 1);
+    }
+
+    unsigned int group = static_cast<unsigned int>(hashValue >> 7) & groupMask;
+    unsigned int free = matchFree(group);
+    for (unsigned int step = 1; free == 0; step++) {
+        group = (group + step) & groupMask;
+        free = matchFree(group);
+    }
+
+    slot = group * GROUP_SIZE + lowestBit(free);
+    if (controls[slot] == DELETED) {
+        tombstones--;
+    }
+    controls[slot] = static_cast<signed char>(hashValue & 0x7F);
+    slots[slot] = std::move(bid);
+    count++;
+}
+
+/**
+ * Visit every bid in the table, slot by slot
+ *
+ * @param visit Function called with each bid
+ */
+void FlatHashTable::ForEach(const function<void(const Bid &)> &visit) {
+    for (unsigned int i = 0; i < controls.size(); i++) {
+        if (controls[i] >= 0) {
+            visit(slots[i]);
+        }
+    }
+}
+
+/**
+ * Print all bids
+ */
+void FlatHashTable::PrintAll() {
+    for (unsigned int i = 0; i < controls.size(); i++) {
+        if (controls[i] >= 0) {
+            cout << i << ": " << slots[i].bidId << " | " << slots[i].title << " | "
+                 << slots[i].amount << " | " << slots[i].fund << endl;
+        }
+    }
+}
+
+/**
+ * Remove a bid
+ *
+ * @param bidId The bid id to search for
+ */
+void FlatHashTable::Remove(string_view bidId) {
+    unsigned int slot;
+
+    if (!find(bidId, hash(bidId), slot)) {
+        return;
+    }
+
+    // No probe ever went past a group that still has an empty slot,
+    // so the slot can go straight back to empty there
+    if (match(slot / GROUP_SIZE, EMPTY) != 0) {
+        controls[slot] = EMPTY;
+    } else {
+        controls[slot] = DELETED;
+        tombstones++;
+    }
+    slots[slot] = Bid();
+    count--;
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid FlatHashTable::Search(string_view bidId) {
+    unsigned int slot;
+
+    if (find(bidId, hash(bidId), slot)) {
+        return slots[slot];
+    }
+    return Bid();
+}
+
+/**
+ * @return The number of bids in the table
+ */
+unsigned int FlatHashTable::Size() const {
+    return count;
+}
+
+//============================================================================
+// Frozen hash table class definition
+//============================================================================
+
+/**
+ * Define a class containing data members and methods to
+ * implement a read-only table over a fixed set of bids. A minimal
+ * perfect hash function gives every id its own index into one
+ * array of bids, so a lookup hashes the id, reads one pilot, and
+ * checks the one bid at that index. Built by HashTable::Freeze
+ * once a month's bids are loaded.
+ */
+class FrozenHashTable {
+
+private:
+    vector<Bid> bids;
+    mph::Function index;
+
+public:
+    FrozenHashTable(vector<Bid> &&loaded);
+    void ForEach(const function<void(const Bid &)> &visit) const;
+    void PrintAll() const;
+    Bid Search(string_view bidId) const;
+    unsigned int Size() const;
+    size_t IndexBytes() const;
+    unsigned int BuildAttempts() const;
+};
+
+/**
+ * Builds the index over the given bids. Only the first bid with
+ * a given id is kept, the same one HashTable::Search would find.
+ *
+ * @param loaded The bids to index, moved in
+ */
+FrozenHashTable::FrozenHashTable(vector<Bid> &&loaded) {
+    vector<uint64_t> hashes;
+    vector<size_t> order(loaded.size());
+
+    // Drops repeated ids: equal ids have equal hashes, so a stable
+    // sort by hash puts the first of them first
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    vector<uint64_t> keyHashes(loaded.size());
+    for (size_t i = 0; i < loaded.size(); i++) {
+        keyHashes[i] = hashBidId(loaded[i].bidId);
+    }
+    stable_sort(order.begin(), order.end(), [&keyHashes](size_t a, size_t b) {
+        return keyHashes[a] < keyHashes[b];
+    });
+    vector<Bid> unique;
+    for (size_t i = 0; i < order.size(); i++) {
+        size_t current = order[i];
+        bool repeated = false;
+        for (size_t j = unique.size(); j > 0 && hashes[j - 1] == keyHashes[current]; j--) {
+            repeated = repeated || unique[j - 1].bidId == loaded[current].bidId;
+        }
+        if (!repeated) {
+            hashes.push_back(keyHashes[current]);
+            unique.push_back(std::move(loaded[current]));
         }
+    }
+    loaded.clear();
+
+    // Each bid moves to the index the function gives its id
+    index.build(hashes);
+    bids.resize(unique.size());
+    for (size_t i = 0; i < unique.size(); i++) {
+        bids[index(hashes[i])] = std::move(unique[i]);
+    }
+}
+
+/**
+ * Visit every bid, in index order
+ *
+ * @param visit Function called with each bid
+ */
+void FrozenHashTable::ForEach(const function<void(const Bid &)> &visit) const {
+    for (const Bid &bid : bids) {
+        visit(bid);
+    }
+}
+
+/**
+ * Print all bids
+ */
+void FrozenHashTable::PrintAll() const {
+    for (size_t i = 0; i < bids.size(); i++) {
+        cout << i << ": " << bids[i].bidId << " | " << bids[i].title << " | "
+             << bids[i].amount << " | " << bids[i].fund << endl;
+    }
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid FrozenHashTable::Search(string_view bidId) const {
+    if (bids.empty()) {
+        return Bid();
+    }
+
+    // Ids that were never loaded land on some bid too, so it is checked
+    const Bid &bid = bids[index(hashBidId(bidId))];
+    if (bid.bidId == bidId) {
+        return bid;
+    }
+    return Bid();
+}
+
+/**
+ * @return The number of bids in the table
+ */
+unsigned int FrozenHashTable::Size() const {
+    return bids.size();
+}
+
+/**
+ * @return The bytes the perfect hash function takes, beside the bids
+ */
+size_t FrozenHashTable::IndexBytes() const {
+    return index.bytes();
+}
+
+/**
+ * @return How many seeds the build went through
+ */
+unsigned int FrozenHashTable::BuildAttempts() const {
+    return index.attempts();
+}
+
+/**
+ * Copies every bid into a read-only table with a perfect hash
+ * index. The table keeps its bids, only growth still pending
+ * is finished first.
+ */
+FrozenHashTable HashTable::Freeze() {
+    bids.finishMigration();
+
+    vector<Bid> loaded;
+    loaded.reserve(bids.size());
+    ForEach([&loaded](const Bid &bid) {
+        loaded.push_back(bid);
+    });
+    return FrozenHashTable(std::move(loaded));
+}
+
+//============================================================================
+// Concurrent hash table class definition
+//============================================================================
+
+/**
+ * Define a class containing data members and methods to
+ * implement a hash table that many threads can use at once.
+ * The ids are split over a power of two number of shards by
+ * the top bits of their hash; each shard is a chained HashTable
+ * behind its own reader-writer lock. Searches in a shard share
+ * its lock, and threads working on different shards never wait
+ * on each other.
+ */
+class ConcurrentHashTable {
+
+private:
+    // Aligned so two shards' locks never share a cache line
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        HashTable table;
     };
 
-    vector<Node> nodes;
+    vector<unique_ptr<Shard>> shards;
+    unsigned int shardBits;
 
-    unsigned int tableSize = DEFAULT_SIZE;
-    unsigned int hash(unsigned int key);
+    unsigned int shardIndex(string_view bidId) const;
+    Shard &shardFor(string_view bidId) const;
 
 public:
-    HashTable();
-    HashTable(unsigned int size);
-    virtual ~HashTable();
+    ConcurrentHashTable();
+    ConcurrentHashTable(unsigned int shardCount);
     void Insert(Bid bid);
+    void InsertBatch(Bid* bids, unsigned int bidCount);
+    void ForEach(const function<void(const Bid &)> &visit);
     void PrintAll();
-    void Remove(string bidId);
-    Bid Search(string bidId);
-
+    void Remove(string_view bidId);
+    Bid Search(string_view bidId) const;
+    unsigned int Size() const;
 };
 
 /**
- * Default constructor
+ * Default constructor, one shard for each of 16 threads
  */
-HashTable::HashTable() {
-
-    // Initialize node structure by resizing tableSize
-    nodes.resize(tableSize);
+ConcurrentHashTable::ConcurrentHashTable() : ConcurrentHashTable(16) {
 }
 
 /**
- * Constructor for specifying size of the table
- * Use to improve efficiency of hashing algorithm
- * by reducing collisions without wasting memory.
+ * Constructor for specifying the number of shards,
+ * rounded up to a power of two
+ *
+ * @param shardCount The number of shards
  */
-HashTable::HashTable(unsigned int size) {
-    // Invokes local table size
-    this->tableSize = size;
-
-    // Resizes nodes vector
-    nodes.resize(tableSize);
+ConcurrentHashTable::ConcurrentHashTable(unsigned int shardCount) {
+    shardBits = 0;
+    while ((1u << shardBits) < shardCount) {
+        shardBits++;
+    }
+    for (unsigned int i = 0; i < (1u << shardBits); i++) {
+        shards.push_back(unique_ptr<Shard>(new Shard()));
+    }
 }
 
 /**
- * Destructor
+ * Picks the shard of a bid id from the top bits of its hash,
+ * which the shard's own table doesn't lean on.
+ *
+ * @param bidId The bid id
+ * @return The index of the shard that holds the id
  */
-HashTable::~HashTable() {
-    // To be thorough, I used erase as a range
-    nodes.erase(nodes.begin(), nodes.end());
-
+unsigned int ConcurrentHashTable::shardIndex(string_view bidId) const {
+    if (shardBits == 0) {
+        return 0;
+    }
+    return static_cast<unsigned int>(hashBidId(bidId) >> (64 - shardBits));
 }
 
 /**
- * Calculate the hash value of a given key.
- * Note that key is specifically defined as
- * unsigned int to prevent undefined results
- * of a negative list index.
- *
- * @param key The key to hash
- * @return The calculated hash
+ * @param bidId The bid id
+ * @return The shard that holds the id
  */
-unsigned int HashTable::hash(unsigned int key) {
-
-    return key % tableSize; // Modulo of the table size calculates the hash value.
+ConcurrentHashTable::Shard &ConcurrentHashTable::shardFor(string_view bidId) const {
+    return *shards[shardIndex(bidId)];
 }
 
 /**
@@ -136,66 +1116,55 @@ unsigned int HashTable::hash(unsigned int key) {
  *
  * @param bid The bid to insert
  */
-void HashTable::Insert(Bid bid) {
-
-    // Converts bidID string to integer using stoi() standard string method introduced in C++11
-    // Then creates a key
-    unsigned key = hash(stoi(bid.bidId));
+void ConcurrentHashTable::Insert(Bid bid) {
+    Shard &shard = shardFor(bid.bidId);
+    unique_lock<shared_mutex> guard(shard.lock);
+    shard.table.Insert(std::move(bid));
+}
 
-    // Retrieves node using its key.
-    Node* oldNode = &(nodes.at(key)); // oldNode points to the memory address
+/**
+ * Insert a run of bids, moving them out of the array. The bids are
+ * sorted out by shard first, so each shard is locked once and gets
+ * its share as one batch.
+ *
+ * @param bids The bids to insert
+ * @param bidCount The number of bids
+ */
+void ConcurrentHashTable::InsertBatch(Bid* bids, unsigned int bidCount) {
+    vector<vector<Bid>> perShard(shards.size());
 
-    // if no entry found for the key
-    if (oldNode == nullptr) {
-        Node* newNode = new Node(bid, key);
-        // Inserts node "key" places from the beginning of the vector
-        nodes.insert(nodes.begin() + key, (*newNode));
+    for (unsigned int i = 0; i < bidCount; i++) {
+        perShard[shardIndex(bids[i].bidId)].push_back(std::move(bids[i]));
     }
-
-    else {
-        // Node found, key for the node entry has not been used yet
-        if (oldNode->key == UINT_MAX) {
-            oldNode->key = key;
-            oldNode->bid = bid;
-            oldNode->next = nullptr; // No more nodes pointed to.
+    for (unsigned int i = 0; i < shards.size(); i++) {
+        if (!perShard[i].empty()) {
+            unique_lock<shared_mutex> guard(shards[i]->lock);
+            shards[i]->table.InsertBatch(perShard[i].data(), perShard[i].size());
         }
-        // Iterate through each node's next pointer. While it isn't null,
-        // make it point to the next null until we find a null pointer.
-        else {
-            while (oldNode->next != nullptr) {
-                oldNode = oldNode->next;
-            }
+    }
+}
 
-            // Appends the new node to the linked list.
-            oldNode->next = new Node(bid, key);
-        }
+/**
+ * Visit every bid in the table, shard by shard. Each shard is
+ * locked for reading while it is visited, so the bids seen are
+ * consistent per shard, not across the whole table.
+ *
+ * @param visit Function called with each bid
+ */
+void ConcurrentHashTable::ForEach(const function<void(const Bid &)> &visit) {
+    for (unique_ptr<Shard> &shard : shards) {
+        shared_lock<shared_mutex> guard(shard->lock);
+        shard->table.ForEach(visit);
     }
 }
 
 /**
  * Print all bids
  */
-void HashTable::PrintAll() {
-
-    // Range-based for loop provides simplicity for iterating through a vector
-    for (Node aNode : nodes) {
-        Node* currentNode = &aNode; // We just need a pointer to the memory address of each node
-
-        // If the key is not equal to UINT_MAX
-        if (currentNode->key != UINT_MAX) {
-            cout << currentNode->key << ": " << currentNode->bid.bidId << " | "
-                << currentNode->bid.title << " | " << currentNode->bid.amount << " | "
-                 << currentNode->bid.fund << endl;
-        }
-
-        // Cycle through the nodes until the final one
-        while (currentNode->next != nullptr) {
-            cout << currentNode->key << ": " << currentNode->bid.bidId << " | "
-                 << currentNode->bid.title << " | " << currentNode->bid.amount << " | "
-                 << currentNode->bid.fund << endl;
-            currentNode = currentNode->next; // Node is equal to the next one
-        }
-
+void ConcurrentHashTable::PrintAll() {
+    for (unique_ptr<Shard> &shard : shards) {
+        shared_lock<shared_mutex> guard(shard->lock);
+        shard->table.PrintAll();
     }
 }
 
@@ -204,12 +1173,10 @@ void HashTable::PrintAll() {
  *
  * @param bidId The bid id to search for
  */
-void HashTable::Remove(string bidId) {
-    // set key equal to bidID converted to integer using C++11 stoi()
-    unsigned key = hash(stoi(bidId));
-
-    // Erases the node
-    nodes.erase(nodes.begin() + key); // Offset, beginning of node plus offset
+void ConcurrentHashTable::Remove(string_view bidId) {
+    Shard &shard = shardFor(bidId);
+    unique_lock<shared_mutex> guard(shard.lock);
+    shard.table.Remove(bidId);
 }
 
 /**
@@ -217,33 +1184,22 @@ void HashTable::Remove(string bidId) {
  *
  * @param bidId The bid id to search for
  */
-Bid HashTable::Search(string bidId) {
-    Bid bid;
-
-    // Creates the key for the given bid transformed into an int using C++11 stoi()
-    unsigned key = hash(stoi(bidId));
-    // Retrieves node using its key.
-    Node* node = &(nodes.at(key)); // oldNode points to the memory address
-
-    // If no entry found for the key
-    if (node == nullptr || node->key == UINT_MAX) {
-        return bid;
-    }
-    // If matching node entry found
-    if (node != nullptr && node->key != UINT_MAX && node->bid.bidId.compare(bidId) == 0) {
-        return node->bid;
-    }
+Bid ConcurrentHashTable::Search(string_view bidId) const {
+    Shard &shard = shardFor(bidId);
+    shared_lock<shared_mutex> guard(shard.lock);
+    return shard.table.Search(bidId);
+}
 
-    // Walk the linked list to find the match
-    while (node != nullptr) {
-        // Current node matches the node/key
-        if (node->key != UINT_MAX && node->bid.bidId.compare(bidId) == 0) {
-            return node->bid;
-        }
-        node = node->next;
+/**
+ * @return The number of bids in the table
+ */
+unsigned int ConcurrentHashTable::Size() const {
+    unsigned int total = 0;
+    for (const unique_ptr<Shard> &shard : shards) {
+        shared_lock<shared_mutex> guard(shard->lock);
+        total += shard->table.Size();
     }
-
-    return bid;
+    return total;
 }
 
 //============================================================================
@@ -267,11 +1223,12 @@ void displayBid(Bid bid) {
  * @param csvPath the path to the CSV file to load
  * @return a container holding all the bids read
  */
-void loadBids(const string& csvPath, HashTable* hashTable) {
+template <typename Table>
+void loadBids(const string& csvPath, Table* hashTable) {
     cout << "Loading CSV file " << csvPath << endl;
 
     // Initializes the CSV Parser using the given path
-    csv::Parser file = csv::Parser(csvPath);
+    csv::Reader file = csv::Reader(csvPath);
 
     // Reads and displays the header row - optional
     vector<string> header = file.getHeader();
@@ -280,36 +1237,103 @@ void loadBids(const string& csvPath, HashTable* hashTable) {
     }
     cout << "" << endl;
 
+    // Rows go into the table a batch at a time
+    vector<Bid> batch;
+    batch.reserve(LOAD_BATCH);
+
     try {
+        // Resolves each column by name once so rows are indexed without a lookup.
+        // The Dec 2016 extract names its columns differently from the monthly exports.
+        const csv::ColumnHandle titleColumn = file.column({"Auction Title", "ArticleTitle"});
+        const csv::ColumnHandle idColumn = file.column({"Auction ID", "ArticleID"});
+        const csv::ColumnHandle amountColumn = file.column({"Winning Bid", "WinningBid"});
+        const csv::ColumnHandle fundColumn = file.column("Fund");
+
+        // Only these columns are kept, the tokenizer skips the rest of each line
+        file.project({titleColumn.index, idColumn.index, amountColumn.index, fundColumn.index});
+
         // Loops to read rows of a CSV file
-        for (unsigned int i = 0; i < file.rowCount(); i++) {
+        for (const csv::Row &row : file) {
 
             // Creates a data structure and add to the collection of bids
             Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
-
-            // Pushes this bid to the end
-            hashTable->Insert(bid);
+            bid.bidId = row[idColumn];
+            bid.title = row[titleColumn];
+            bid.fund = row[fundColumn];
+            bid.amount = row.getCurrency(amountColumn);
+
+            // Pushes this bid to the end of the batch
+            batch.push_back(std::move(bid));
+            if (batch.size() == LOAD_BATCH) {
+                hashTable->InsertBatch(batch.data(), batch.size());
+                batch.clear();
+            }
         }
     } catch (csv::Error &e) {
         std::cerr << e.what() << std::endl;
     }
+
+    // Rows read before the end of the file or an error still go in
+    hashTable->InsertBatch(batch.data(), batch.size());
 }
 
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
+ * Save every bid in the table to a binary snapshot file
  *
- * credit: http://stackoverflow.com/a/24875936
+ * @param snapshotPath the path of the snapshot file to write
+ * @param hashTable the table holding the bids
+ */
+void saveSnapshot(const string &snapshotPath, HashTable* hashTable) {
+    try {
+        snapshot::Writer writer;
+        hashTable->ForEach([&writer](const Bid &bid) {
+            writer.add(bid.bidId, bid.title, bid.fund, bid.amount);
+        });
+        writer.save(snapshotPath);
+        cout << writer.size() << " bids saved to " << snapshotPath << endl;
+    } catch (snapshot::Error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+/**
+ * Load bids from a binary snapshot file instead of parsing the CSV file
  *
- * @param ch The character to strip out
+ * @param snapshotPath the path of the snapshot file to read
+ * @param hashTable the table to insert the bids into
  */
-double strToDouble(string str, char ch) {
-    str.erase(remove(str.begin(), str.end(), ch), str.end());
-    return atof(str.c_str());
+template <typename Table>
+void loadSnapshot(const string &snapshotPath, Table* hashTable) {
+    cout << "Loading snapshot " << snapshotPath << endl;
+
+    try {
+        // Maps the file, the records are read straight out of the mapping
+        snapshot::Reader snap = snapshot::Reader(snapshotPath);
+
+        // Bids go in a batch at a time, as they do from the CSV file
+        vector<Bid> batch;
+        batch.reserve(LOAD_BATCH);
+
+        for (unsigned int i = 0; i < snap.size(); i++) {
+            Bid bid;
+            bid.bidId = string(snap.bidId(i));
+            bid.title = string(snap.title(i));
+            bid.fund = string(snap.fund(i));
+            bid.amount = snap.amount(i);
+
+            batch.push_back(std::move(bid));
+            if (batch.size() == LOAD_BATCH) {
+                hashTable->InsertBatch(batch.data(), batch.size());
+                batch.clear();
+            }
+        }
+        hashTable->InsertBatch(batch.data(), batch.size());
+    } catch (snapshot::Error &e) {
+        std::cerr << e.what() << std::endl;
+    } catch (csv::Error &e) {
+        // Opening and mapping the file is shared with the CSV parser
+        std::cerr << e.what() << std::endl;
+    }
 }
 
 /**
@@ -324,6 +1348,658 @@ void displayTelemetry(clock_t ticks) {
     cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 }
 
+/**
+ * Prints a table's statistics
+ *
+ * @param stats - the statistics to print
+ */
+void displayStats(const TableStats &stats) {
+    cout << stats.bids << " bids in " << stats.buckets << " buckets, load factor "
+         << stats.loadFactor << endl;
+    cout << stats.usedBuckets << " buckets in use (" << stats.usedBuckets * 100.0 / (stats.buckets + stats.pendingBuckets)
+         << "% of the buckets searched)" << endl;
+    if (stats.pendingBuckets > 0) {
+        cout << stats.pendingBuckets << " old buckets still to migrate" << endl;
+    }
+
+    cout << "chain lengths:" << endl;
+    for (unsigned int length = 0; length < stats.chainLengths.size(); length++) {
+        if (stats.chainLengths[length] > 0) {
+            cout << "  " << length << ": " << stats.chainLengths[length] << " buckets" << endl;
+        }
+    }
+
+    cout << "probes per hit: " << stats.hitProbes << " average, " << stats.maxHitProbes << " max" << endl;
+    cout << "probes per miss: " << stats.missProbes << " average, " << stats.maxMissProbes << " max" << endl;
+    cout << "memory: " << stats.TotalBytes() << " bytes (buckets " << stats.bucketBytes << ", nodes "
+         << stats.nodeBytes << ", strings " << stats.stringBytes << ", filter " << stats.filterBytes
+         << ")" << endl;
+}
+
+/**
+ * Writes a table's statistics to a JSON file, so runs with other
+ * table sizes or hash functions can be compared side by side.
+ *
+ * @param statsPath - the path of the JSON file to write
+ * @param stats - the statistics to write
+ */
+void exportStats(const string &statsPath, const TableStats &stats) {
+    ofstream file(statsPath);
+    if (!file) {
+        cerr << "Could not write " << statsPath << endl;
+        return;
+    }
+
+    file << "{" << endl;
+    file << "  \"bids\": " << stats.bids << "," << endl;
+    file << "  \"buckets\": " << stats.buckets << "," << endl;
+    file << "  \"usedBuckets\": " << stats.usedBuckets << "," << endl;
+    file << "  \"pendingBuckets\": " << stats.pendingBuckets << "," << endl;
+    file << "  \"loadFactor\": " << stats.loadFactor << "," << endl;
+    file << "  \"chainLengths\": [";
+    for (unsigned int length = 0; length < stats.chainLengths.size(); length++) {
+        file << (length > 0 ? ", " : "") << stats.chainLengths[length];
+    }
+    file << "]," << endl;
+    file << "  \"hitProbes\": {\"average\": " << stats.hitProbes << ", \"max\": " << stats.maxHitProbes
+         << "}," << endl;
+    file << "  \"missProbes\": {\"average\": " << stats.missProbes << ", \"max\": " << stats.maxMissProbes
+         << "}," << endl;
+    file << "  \"memory\": {\"buckets\": " << stats.bucketBytes << ", \"nodes\": " << stats.nodeBytes
+         << ", \"strings\": " << stats.stringBytes << ", \"filter\": " << stats.filterBytes
+         << ", \"total\": " << stats.TotalBytes() << "}" << endl;
+    file << "}" << endl;
+    cout << "Statistics written to " << statsPath << endl;
+}
+
+/**
+ * Streams the CSV file through the tokenizer with each scan kernel the CPU
+ * supports and reports the throughput, so the SIMD kernels can be compared
+ * against the scalar one.
+ *
+ * @param csvPath - the path to the CSV file to scan
+ */
+void benchmarkTokenizer(const string &csvPath) {
+    const csv::ScanKernel kernels[] = {csv::eSCALAR, csv::eSSE2, csv::eAVX2};
+    const char* names[] = {"scalar", "SSE2", "AVX2"};
+    const int passes = 20;
+    csv::ScanKernel original = csv::getScanKernel();
+
+    // The file size times the passes gives the bytes scanned per kernel
+    ifstream file(csvPath, ios::binary | ios::ate);
+    double bytes = static_cast<double>(file.tellg()) * passes;
+    file.close();
+
+    for (int k = 0; k < 3; k++) {
+        if (!csv::setScanKernel(kernels[k])) {
+            cout << names[k] << ": not supported on this CPU" << endl;
+            continue;
+        }
+
+        unsigned long fields = 0;
+        clock_t ticks = clock();
+        for (int pass = 0; pass < passes; pass++) {
+            csv::Reader reader = csv::Reader(csvPath);
+            for (const csv::Row &row : reader) {
+                fields += row.size();
+            }
+        }
+        ticks = clock() - ticks;
+
+        double seconds = ticks * 1.0 / CLOCKS_PER_SEC;
+        cout << names[k] << ": " << fields << " fields in " << seconds << " seconds, "
+             << bytes / seconds / 1000000.0 << " MB/s" << endl;
+    }
+
+    // Puts back the kernel picked at startup
+    csv::setScanKernel(original);
+}
+
+/**
+ * Compares restarting from the CSV file with restarting from a snapshot:
+ * loads the CSV into a fresh table, saves that as a snapshot, then loads
+ * the snapshot into another fresh table.
+ *
+ * @param csvPath - the path to the CSV file
+ * @param snapshotPath - the path of the snapshot file to write and read
+ */
+void benchmarkLoadTimes(const string &csvPath, const string &snapshotPath) {
+    HashTable* csvTable = new HashTable();
+    clock_t ticks = clock();
+    loadBids(csvPath, csvTable);
+    clock_t csvTicks = clock() - ticks;
+
+    saveSnapshot(snapshotPath, csvTable);
+
+    HashTable* snapshotTable = new HashTable();
+    ticks = clock();
+    loadSnapshot(snapshotPath, snapshotTable);
+    clock_t snapshotTicks = clock() - ticks;
+
+    cout << "CSV load: " << csvTicks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+    cout << "Snapshot load: " << snapshotTicks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+    if (snapshotTicks > 0) {
+        cout << "Snapshot is " << csvTicks * 1.0 / snapshotTicks << "x faster" << endl;
+    }
+
+    delete csvTable;
+    delete snapshotTable;
+}
+
+/**
+ * Looks a bid up in one of the bid tables
+ *
+ * @param table - the table to search
+ * @param bidId - the id to look for
+ * @return true when the table holds the bid
+ */
+template <typename Table>
+bool containsBid(Table* table, const string &bidId) {
+    return !table->Search(bidId).bidId.empty();
+}
+
+/**
+ * Adds a bid to one of the bid tables, moving it in
+ *
+ * @param table - the table to insert into
+ * @param bid - the bid to insert
+ */
+template <typename Table>
+void insertBid(Table* table, Bid &&bid) {
+    table->Insert(std::move(bid));
+}
+
+/**
+ * Times Search on a table for ids it holds and ids it doesn't,
+ * and prints the average latency of each.
+ *
+ * @param name - the table's label in the report
+ * @param table - the table to search
+ * @param hits - ids that are in the table
+ * @param misses - ids that are not in the table
+ */
+template <typename Table>
+void timeLookups(const string &name, Table* table, const vector<string> &hits, const vector<string> &misses) {
+    unsigned int found = 0;
+
+    clock_t ticks = clock();
+    for (const string &id : hits) {
+        found += containsBid(table, id);
+    }
+    double hitSeconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    ticks = clock();
+    for (const string &id : misses) {
+        found += containsBid(table, id);
+    }
+    double missSeconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    cout << "  " << name << ": hit " << hitSeconds * 1e9 / hits.size() << " ns, miss "
+         << missSeconds * 1e9 / misses.size() << " ns per lookup (" << found << " found)" << endl;
+}
+
+/**
+ * Builds a synthetic bid whose id is derived from its number
+ *
+ * @param i - the bid's number
+ */
+Bid syntheticBid(unsigned int i) {
+    Bid bid;
+    bid.bidId = to_string(100000000 + i);
+    bid.title = "Synthetic Bid";
+    bid.fund = "General Fund";
+    bid.amount = i % 1000;
+    return bid;
+}
+
+/**
+ * Inserts synthetic bids into a table and prints the total time and
+ * the slowest single Insert, which shows any pause for growing.
+ *
+ * @param name - the table's label in the report
+ * @param table - the table to fill
+ * @param bids - the number of bids to insert
+ */
+template <typename Table>
+void timeInserts(const string &name, Table* table, unsigned int bids) {
+    chrono::steady_clock::duration worst = chrono::steady_clock::duration::zero();
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned int i = 0; i < bids; i++) {
+        Bid bid = syntheticBid(i);
+        chrono::steady_clock::time_point before = chrono::steady_clock::now();
+        insertBid(table, std::move(bid));
+        worst = max(worst, chrono::steady_clock::now() - before);
+    }
+    chrono::duration<double> total = chrono::steady_clock::now() - start;
+
+    cout << "  " << name << ": " << bids << " inserts in " << total.count() << " seconds, slowest "
+         << chrono::duration<double, micro>(worst).count() << " us" << endl;
+}
+
+/**
+ * Compares lookup latency of the chained and the open addressing
+ * tables, first on the bids in the CSV file, then on a synthetic
+ * set of SYNTHETIC_BIDS bids. Every table starts at its
+ * default size and grows as the bids go in.
+ *
+ * @param csvPath - the path to the CSV file
+ */
+void benchmarkTables(const string &csvPath) {
+    const unsigned int lookups = 1000000;
+    mt19937 random(42);
+    vector<string> hits;
+    vector<string> misses;
+
+    // Real bids looked up in random order, and the same ids with a
+    // suffix no real id has
+    HashTable* chained = new HashTable();
+    loadBids(csvPath, chained);
+    chained->ForEach([&hits, &misses](const Bid &bid) {
+        hits.push_back(bid.bidId);
+        misses.push_back(bid.bidId + "-x");
+    });
+    shuffle(hits.begin(), hits.end(), random);
+
+    FlatHashTable* flat = new FlatHashTable();
+    loadBids(csvPath, flat);
+
+    cout << hits.size() << " bids from " << csvPath << ":" << endl;
+    timeLookups("chained", chained, hits, misses);
+    timeLookups("open addressing", flat, hits, misses);
+    delete chained;
+    delete flat;
+
+    // Synthetic bids, one table at a time to keep memory down
+    uniform_int_distribution<unsigned int> pick(0, SYNTHETIC_BIDS - 1);
+    hits.clear();
+    misses.clear();
+    for (unsigned int i = 0; i < lookups; i++) {
+        hits.push_back(syntheticBid(pick(random)).bidId);
+        misses.push_back(syntheticBid(SYNTHETIC_BIDS + pick(random)).bidId);
+    }
+
+    cout << SYNTHETIC_BIDS << " synthetic bids:" << endl;
+    chained = new HashTable();
+    timeInserts("chained", chained, SYNTHETIC_BIDS);
+    timeLookups("chained", chained, hits, misses);
+    delete chained;
+
+    flat = new FlatHashTable();
+    timeInserts("open addressing", flat, SYNTHETIC_BIDS);
+    timeLookups("open addressing", flat, hits, misses);
+    delete flat;
+}
+
+/**
+ * Times hashing a set of ids a number of times over and prints
+ * the throughput.
+ *
+ * @param name - the hash's label in the report
+ * @param ids - the ids to hash
+ * @param passes - how many times to hash the whole set
+ * @param hash - the hash to time
+ */
+void timeHash(const string &name, const vector<string> &ids, unsigned int passes,
+              const function<uint64_t(const string &)> &hash) {
+    // Only there so the compiler can't drop the hashing as unused
+    volatile uint64_t sink = 0;
+
+    clock_t ticks = clock();
+    for (unsigned int pass = 0; pass < passes; pass++) {
+        uint64_t sum = 0;
+        for (const string &id : ids) {
+            sum += hash(id);
+        }
+        sink = sink + sum;
+    }
+    double seconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    cout << "  " << name << ": " << ids.size() * passes / seconds / 1000000.0 << " million ids/s" << endl;
+}
+
+/**
+ * Compares the string hash against the old stoi() and modulo key on
+ * the ids in the CSV file, then hashes alphanumeric ids like
+ * AUC-2024-0001 that stoi() can't take at all.
+ *
+ * @param csvPath - the path to the CSV file
+ */
+void benchmarkHashing(const string &csvPath) {
+    const unsigned int passes = 200;
+    vector<string> ids;
+
+    HashTable* table = new HashTable();
+    loadBids(csvPath, table);
+    table->ForEach([&ids](const Bid &bid) {
+        ids.push_back(bid.bidId);
+    });
+    delete table;
+
+    cout << ids.size() << " ids from " << csvPath << ":" << endl;
+    try {
+        timeHash("stoi + modulo", ids, passes, [](const string &id) {
+            return static_cast<uint64_t>(static_cast<unsigned int>(stoi(id)) % DEFAULT_SIZE);
+        });
+    } catch (exception &e) {
+        cout << "  stoi + modulo: fails on these ids (" << e.what() << ")" << endl;
+    }
+    timeHash("hashBidId + modulo", ids, passes, [](const string &id) {
+        return hashBidId(id) % DEFAULT_SIZE;
+    });
+
+    for (unsigned int i = 0; i < ids.size(); i++) {
+        string number = to_string(i + 1);
+        ids[i] = "AUC-2024-" + string(number.size() < 4 ? 4 - number.size() : 0, '0') + number;
+    }
+    cout << ids.size() << " alphanumeric ids (" << ids.front() << " ...):" << endl;
+    timeHash("hashBidId + modulo", ids, passes, [](const string &id) {
+        return hashBidId(id) % DEFAULT_SIZE;
+    });
+}
+
+/**
+ * Runs Search from a number of threads at once, optionally while
+ * another thread keeps inserting new bids, and returns the searches
+ * per second across all the searching threads.
+ *
+ * @param table - the table to search
+ * @param ids - the ids to look up, each thread starts at its own offset
+ * @param threads - the number of searching threads
+ * @param seconds - how long the threads run
+ * @param loading - whether a loader thread inserts at the same time
+ * @param nextBid - the number of the next synthetic bid for the loader
+ */
+double measureConcurrentSearch(ConcurrentHashTable* table, const vector<string> &ids, unsigned int threads,
+                               double seconds, bool loading, unsigned int &nextBid) {
+    atomic<bool> stop(false);
+    vector<unsigned long> counts(threads, 0);
+    vector<thread> workers;
+
+    for (unsigned int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            unsigned long done = 0;
+            size_t i = t * ids.size() / threads;
+            while (!stop.load(memory_order_relaxed)) {
+                // Checks the clock flag once per batch of searches
+                for (unsigned int batch = 0; batch < 256; batch++) {
+                    table->Search(ids[i]);
+                    done++;
+                    i = (i + 1 == ids.size()) ? 0 : i + 1;
+                }
+            }
+            counts[t] = done;
+        });
+    }
+    thread loader;
+    if (loading) {
+        loader = thread([&]() {
+            while (!stop.load(memory_order_relaxed)) {
+                table->Insert(syntheticBid(nextBid++));
+            }
+        });
+    }
+
+    this_thread::sleep_for(chrono::duration<double>(seconds));
+    stop = true;
+    for (thread &worker : workers) {
+        worker.join();
+    }
+    if (loader.joinable()) {
+        loader.join();
+    }
+
+    unsigned long total = 0;
+    for (unsigned long done : counts) {
+        total += done;
+    }
+    return total / seconds;
+}
+
+/**
+ * Reports Search throughput on the concurrent table at 1, 2, 4, 8
+ * and 16 threads, first with the table only being read, then with a
+ * loader thread inserting synthetic bids the whole time.
+ *
+ * @param csvPath - the path to the CSV file
+ */
+void benchmarkConcurrency(const string &csvPath) {
+    const unsigned int threadCounts[] = {1, 2, 4, 8, 16};
+    const double seconds = 1.0;
+    unsigned int nextBid = 0;
+    vector<string> ids;
+
+    ConcurrentHashTable* table = new ConcurrentHashTable();
+    loadBids(csvPath, table);
+    table->ForEach([&ids](const Bid &bid) {
+        ids.push_back(bid.bidId);
+    });
+    shuffle(ids.begin(), ids.end(), mt19937(42));
+
+    cout << "Hardware threads: " << thread::hardware_concurrency() << endl;
+    for (bool loading : {false, true}) {
+        cout << (loading ? "Searching while a loader inserts:" : "Searching only:") << endl;
+        for (unsigned int threads : threadCounts) {
+            unsigned int before = nextBid;
+            double rate = measureConcurrentSearch(table, ids, threads, seconds, loading, nextBid);
+            cout << "  " << threads << " threads: " << rate / 1000000.0 << " million searches/s";
+            if (loading) {
+                cout << ", " << (nextBid - before) / seconds << " inserts/s";
+            }
+            cout << endl;
+        }
+    }
+    delete table;
+}
+
+/**
+ * Times filling a table with one Insert per bid against InsertBatch
+ * over the same bids.
+ *
+ * @param name - the table's label in the report
+ * @param bids - the bids to insert, copied for each run
+ */
+template <typename Table>
+void timeBatchInsert(const string &name, const vector<Bid> &bids) {
+    vector<Bid> copy = bids;
+    Table* table = new Table();
+    clock_t ticks = clock();
+    for (Bid &bid : copy) {
+        table->Insert(std::move(bid));
+    }
+    double single = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+    delete table;
+
+    copy = bids;
+    table = new Table();
+    ticks = clock();
+    table->InsertBatch(copy.data(), copy.size());
+    double batched = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+    delete table;
+
+    cout << "  " << name << ": Insert " << single << " seconds, InsertBatch " << batched
+         << " seconds, " << single / batched << "x" << endl;
+}
+
+/**
+ * Compares single and batched inserts on tables well past the size
+ * of the L2 cache, using synthetic bids in random id order.
+ */
+void benchmarkBatchInsert() {
+    const unsigned int sizes[] = {100000, 1000000, 4000000};
+    mt19937 random(42);
+
+    for (unsigned int size : sizes) {
+        vector<Bid> bids;
+        bids.reserve(size);
+        for (unsigned int i = 0; i < size; i++) {
+            bids.push_back(syntheticBid(i));
+        }
+        shuffle(bids.begin(), bids.end(), random);
+
+        cout << size << " bids:" << endl;
+        timeBatchInsert<HashTable>("chained", bids);
+        timeBatchInsert<FlatHashTable>("open addressing", bids);
+    }
+}
+
+/**
+ * Times lookups on a chained table without and then with its Bloom
+ * filter, and reports the filter's false positive rate, measured on
+ * the misses and estimated from its fill, and its memory cost.
+ *
+ * @param name - the label of the bid set in the report
+ * @param table - the table, holding every id in hits
+ * @param hits - ids that are in the table
+ * @param misses - ids that are not in the table
+ */
+void reportFilter(const string &name, HashTable* table, const vector<string> &hits, const vector<string> &misses) {
+    cout << name << ":" << endl;
+    table->DisableFilter();
+    timeLookups("without filter", table, hits, misses);
+    table->EnableFilter();
+    timeLookups("with filter", table, hits, misses);
+
+    const bloom::Filter &filter = table->GetFilter();
+    unsigned int passed = 0;
+    for (const string &id : misses) {
+        passed += filter.mayContain(hashBidId(id));
+    }
+    cout << "  false positives: " << passed * 100.0 / misses.size() << "% measured, "
+         << filter.falsePositiveRate() * 100.0 << "% estimated" << endl;
+    cout << "  filter memory: " << filter.bytes() << " bytes, "
+         << filter.bytes() * 8.0 / table->Size() << " bits per bid" << endl;
+}
+
+/**
+ * Shows what the Bloom filter does for misses on the bids in the CSV
+ * file and on a million synthetic bids.
+ *
+ * @param csvPath - the path to the CSV file
+ */
+void benchmarkFilter(const string &csvPath) {
+    const unsigned int synthetic = 1000000;
+    mt19937 random(42);
+    vector<string> hits;
+    vector<string> misses;
+
+    HashTable* table = new HashTable();
+    loadBids(csvPath, table);
+    table->ForEach([&hits, &misses](const Bid &bid) {
+        hits.push_back(bid.bidId);
+        misses.push_back(bid.bidId + "-x");
+    });
+    shuffle(hits.begin(), hits.end(), random);
+    reportFilter(to_string(hits.size()) + " bids from " + csvPath, table, hits, misses);
+    delete table;
+
+    hits.clear();
+    misses.clear();
+    table = new HashTable();
+    for (unsigned int i = 0; i < synthetic; i++) {
+        table->Insert(syntheticBid(i));
+    }
+    uniform_int_distribution<unsigned int> pick(0, synthetic - 1);
+    for (unsigned int i = 0; i < synthetic; i++) {
+        hits.push_back(syntheticBid(pick(random)).bidId);
+        misses.push_back(syntheticBid(synthetic + pick(random)).bidId);
+    }
+    reportFilter(to_string(synthetic) + " synthetic bids", table, hits, misses);
+    delete table;
+}
+
+/**
+ * Freezes a table and reports the build time, the size of the
+ * perfect hash index, and lookup latency next to the mutable table.
+ *
+ * @param name - the label of the bid set in the report
+ * @param table - the table to freeze, holding every id in hits
+ * @param hits - ids that are in the table
+ * @param misses - ids that are not in the table
+ */
+void reportFreeze(const string &name, HashTable* table, const vector<string> &hits, const vector<string> &misses) {
+    cout << name << ":" << endl;
+
+    clock_t ticks = clock();
+    FrozenHashTable frozen = table->Freeze();
+    double seconds = (clock() - ticks) * 1.0 / CLOCKS_PER_SEC;
+
+    cout << "  freeze: " << seconds << " seconds, " << frozen.IndexBytes() * 8.0 / frozen.Size()
+         << " bits per bid, " << frozen.BuildAttempts() << " seed(s) tried" << endl;
+    timeLookups("mutable", table, hits, misses);
+    timeLookups("frozen", &frozen, hits, misses);
+}
+
+/**
+ * Compares the frozen table with the mutable chained table on the
+ * bids in the CSV file and on a million synthetic bids.
+ *
+ * @param csvPath - the path to the CSV file
+ */
+void benchmarkFreeze(const string &csvPath) {
+    const unsigned int synthetic = 1000000;
+    mt19937 random(42);
+    vector<string> hits;
+    vector<string> misses;
+
+    HashTable* table = new HashTable();
+    loadBids(csvPath, table);
+    table->ForEach([&hits, &misses](const Bid &bid) {
+        hits.push_back(bid.bidId);
+        misses.push_back(bid.bidId + "-x");
+    });
+    shuffle(hits.begin(), hits.end(), random);
+    reportFreeze(to_string(hits.size()) + " bids from " + csvPath, table, hits, misses);
+    delete table;
+
+    hits.clear();
+    misses.clear();
+    table = new HashTable();
+    for (unsigned int i = 0; i < synthetic; i++) {
+        table->Insert(syntheticBid(i));
+    }
+    uniform_int_distribution<unsigned int> pick(0, synthetic - 1);
+    for (unsigned int i = 0; i < synthetic; i++) {
+        hits.push_back(syntheticBid(pick(random)).bidId);
+        misses.push_back(syntheticBid(synthetic + pick(random)).bidId);
+    }
+    reportFreeze(to_string(synthetic) + " synthetic bids", table, hits, misses);
+    delete table;
+}
+
+/**
+ * Runs one benchmark, picked by name on the command line with
+ * --bench, instead of the menu.
+ *
+ * @param name - the benchmark to run
+ * @param csvPath - the path to the CSV file the benchmark reads
+ * @return 0, or 1 when there is no benchmark by that name
+ */
+int runBenchmark(const string &name, const string &csvPath) {
+    if (name == "tokenizer") {
+        benchmarkTokenizer(csvPath);
+    } else if (name == "load") {
+        benchmarkLoadTimes(csvPath, csvPath + ".snap");
+    } else if (name == "tables") {
+        benchmarkTables(csvPath);
+    } else if (name == "hashing") {
+        benchmarkHashing(csvPath);
+    } else if (name == "concurrency") {
+        benchmarkConcurrency(csvPath);
+    } else if (name == "batch") {
+        benchmarkBatchInsert();
+    } else if (name == "filter") {
+        benchmarkFilter(csvPath);
+    } else if (name == "freeze") {
+        benchmarkFreeze(csvPath);
+    } else {
+        cerr << "Unknown benchmark " << name << ", expected one of: tokenizer, load, tables, hashing,"
+             << " concurrency, batch, filter, freeze" << endl;
+        return 1;
+    }
+    return 0;
+}
+
 /**
  *
  * Handles and checks command-line arguments during execution and stores the csv file path into a variable
@@ -358,6 +2034,8 @@ string processCommandLine(int argc, char* argv[]) {
 void mainMenu(const string &path) {
 
     const string &csvPath = path;
+    const string snapshotPath = csvPath + ".snap";
+    const string statsPath = csvPath + ".stats.json";
     string searchValue = {};
     clock_t ticks;
 
@@ -374,6 +2052,10 @@ void mainMenu(const string &path) {
         cout << "  2. Display All Bids" << endl;
         cout << "  3. Find Bid" << endl;
         cout << "  4. Remove Bid" << endl;
+        cout << "  5. Save Snapshot" << endl;
+        cout << "  6. Load Snapshot" << endl;
+        cout << "  7. Display Table Statistics" << endl;
+        cout << "  8. Export Table Statistics" << endl;
         cout << "  9. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
@@ -431,6 +2113,26 @@ void mainMenu(const string &path) {
                 }
                 break;
 
+            case 5:
+                saveSnapshot(snapshotPath, bidTable);
+                break;
+
+            case 6:
+                ticks = clock();
+
+                loadSnapshot(snapshotPath, bidTable);
+
+                displayTelemetry(ticks);
+                break;
+
+            case 7:
+                displayStats(bidTable->Stats());
+                break;
+
+            case 8:
+                exportStats(statsPath, bidTable->Stats());
+                break;
+
             default:
                 cout << "Goodbye." << endl;
                 break;
@@ -441,10 +2143,17 @@ void mainMenu(const string &path) {
 /**
  * The one and only main() method
  *
+ * HashTable [csvPath] opens the menu, HashTable --bench <name> [csvPath]
+ * runs one benchmark and exits.
+ *
  * @param arg[1] path to CSV file to load from (optional)
  * @param arg[2] the bid Id to use when searching the list (optional)
  */
 int main(int argc, char* argv[]) {
+    if (argc >= 3 && string(argv[1]) == "--bench") {
+        // The arguments after the name are read as if the name were the program
+        return runBenchmark(argv[2], processCommandLine(argc - 2, argv + 2));
+    }
     mainMenu(processCommandLine(argc, argv));
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+#ifndef LINKEDLIST_NODEPOOL_H
+#define LINKEDLIST_NODEPOOL_H
+
+# include <algorithm>
+# include <cstddef>
+# include <memory>
+# include <new>
+# include <type_traits>
+# include <utility>
+# include <vector>
+
+/*
+** Slab allocator for the nodes of one container. Nodes are carved out of
+** blocks of BLOCK_NODES in the order they are created, so a container
+** loaded in one go has its nodes packed together instead of scattered
+** between the heap buffers of their strings. A destroyed node goes on a
+** free list and is reused before the pool grows. Destroying the pool
+** destroys the nodes still alive and frees whole blocks, the container
+** doesn't have to walk itself node by node.
+**
+** A pool is not thread-safe; it belongs to the container (or shard) that
+** uses it.
+*/
+namespace pool
+{
+    template<typename T, std::size_t BLOCK_NODES = 1024>
+    class NodePool
+    {
+
+    private:
+        union Slot
+        {
+            Slot *next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+    public:
+        NodePool(void) : _used(BLOCK_NODES), _free(nullptr), _live(0)
+        {
+        }
+
+        ~NodePool(void)
+        {
+            clear();
+        }
+
+        NodePool(const NodePool &) = delete;
+        NodePool &operator=(const NodePool &) = delete;
+
+    public:
+        template<typename... Args>
+        T *create(Args &&... args)
+        {
+            Slot *slot = _free;
+
+            if (slot != nullptr)
+                _free = slot->next;
+            else
+            {
+                if (_used == BLOCK_NODES)
+                {
+                    _blocks.emplace_back(new Slot[BLOCK_NODES]);
+                    _used = 0;
+                }
+                slot = &_blocks.back()[_used++];
+            }
+
+            T *node;
+            try
+            {
+                node = ::new(static_cast<void *>(slot->storage)) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                slot->next = _free;
+                _free = slot;
+                throw;
+            }
+            _live++;
+            return node;
+        }
+
+        void destroy(T *node)
+        {
+            if (node == nullptr)
+                return;
+
+            node->~T();
+            Slot *slot = reinterpret_cast<Slot *>(node);
+            slot->next = _free;
+            _free = slot;
+            _live--;
+        }
+
+        /*
+        ** Destroys every live node and frees the blocks. Pointers handed
+        ** out before are all invalid afterwards.
+        */
+        void clear(void)
+        {
+            if (!std::is_trivially_destructible<T>::value && _live > 0)
+            {
+                // Slots on the free list hold no node; sorted so each
+                // used slot can be checked against them
+                std::vector<Slot *> freed;
+                for (Slot *slot = _free; slot != nullptr; slot = slot->next)
+                    freed.push_back(slot);
+                std::sort(freed.begin(), freed.end());
+
+                for (std::size_t b = 0; b < _blocks.size(); b++)
+                {
+                    std::size_t used = (b + 1 == _blocks.size()) ? _used : BLOCK_NODES;
+                    for (std::size_t i = 0; i < used; i++)
+                    {
+                        Slot *slot = &_blocks[b][i];
+                        if (freed.empty() || !std::binary_search(freed.begin(), freed.end(), slot))
+                            reinterpret_cast<T *>(slot->storage)->~T();
+                    }
+                }
+            }
+
+            _blocks.clear();
+            _used = BLOCK_NODES;
+            _free = nullptr;
+            _live = 0;
+        }
+
+        std::size_t size(void) const
+        {
+            return _live;
+        }
+
+        // bytes held in blocks, live or not
+        std::size_t capacity(void) const
+        {
+            return _blocks.size() * BLOCK_NODES * sizeof(Slot);
+        }
+
+    private:
+        std::vector<std::unique_ptr<Slot[]>> _blocks;
+        std::size_t _used;
+        Slot *_free;
+        std::size_t _live;
+    };
+}
+
+#endif //LINKEDLIST_NODEPOOL_H
@@ -7,10 +7,13 @@
 //============================================================================
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <time.h>
 
+#include "BidSnapshot.h"
 #include "CSVparser.h"
+#include "NodePool.h"
 
 using namespace std;
 
@@ -53,9 +56,8 @@ private:
             next = nullptr;
         }
 
-        // initialize with a bid
-        explicit Node(Bid &aBid) {
-            bid = aBid;
+        // initialize with a bid, moved in
+        explicit Node(Bid &&aBid) : bid(std::move(aBid)) {
             next = nullptr;
         }
     };
@@ -64,11 +66,15 @@ private:
     Node* tail;
     int size = 0;
 
+    // Every node of the list comes from here and goes back here
+    pool::NodePool<Node> nodePool;
+
 public:
     LinkedList();
     virtual ~LinkedList();
     void Append(Bid bid);
     void Prepend(Bid bid);
+    void ForEach(const function<void(const Bid &)> &visit);
     void PrintList();
     void Remove(string bidId);
     Bid Search(string bidId);
@@ -88,16 +94,7 @@ LinkedList::LinkedList() {
  * Destructor
  */
 LinkedList::~LinkedList() {
-    // start at the head
-    Node* current = head;
-    Node* temp;
-
-    // loop over each node, detach from list then delete
-    while (current != nullptr) {
-        temp = current; // hang on to current node
-        current = current->next; // make current the next node
-        delete temp; // delete the orphan node
-    }
+    // The node pool releases every node in whole blocks
 }
 
 /**
@@ -105,7 +102,7 @@ LinkedList::~LinkedList() {
  */
 void LinkedList::Append(Bid bid) {
     // Creating a new node
-    Node* newNode = new Node(bid);
+    Node* newNode = nodePool.create(std::move(bid));
 
     // Empty list, assign the newest node to the head.
     if (head == nullptr) {
@@ -132,7 +129,7 @@ void LinkedList::Append(Bid bid) {
  */
 void LinkedList::Prepend(Bid bid) {
     // Create the new node
-    Node* newNode = new Node(bid);
+    Node* newNode = nodePool.create(std::move(bid));
 
     // If the list is populated and has a head.
     if (head != nullptr) {
@@ -147,6 +144,17 @@ void LinkedList::Prepend(Bid bid) {
     ++size;
 }
 
+/**
+ * Visit every bid from head to tail
+ *
+ * @param visit Function called with each bid
+ */
+void LinkedList::ForEach(const function<void(const Bid &)> &visit) {
+    for (Node* node = head; node != nullptr; node = node->next) {
+        visit(node->bid);
+    }
+}
+
 /**
  * Simple output of all bids in the list
  */
@@ -175,7 +183,11 @@ void LinkedList::Remove(const string bidId) {
         // Deletes first element if the head is the matching node
         if (head->bid.bidId.compare(bidId) == 0) {
             Node* temp = head->next; // Temporarily stores address of node after head
-            delete head;
+            // A freed node is reused by the pool, so the tail can't be left pointing at it
+            if (tail == head) {
+                tail = nullptr;
+            }
+            nodePool.destroy(head);
             head = temp; // The node after the old head is now the new head
             --size;
             return;
@@ -184,13 +196,16 @@ void LinkedList::Remove(const string bidId) {
     // The below executes if the matching node is found outside of the head
     Node* currentBid = head; // currentBid iterator temporarily points to the head.
 
-    while (currentBid->next != nullptr) {
+    while (currentBid != nullptr && currentBid->next != nullptr) {
 
         // Peaks at the bid after the current bid's bidID to find a matching bidID
         if (currentBid->next->bid.bidId.compare(bidId) == 0) {
             Node *temp = currentBid->next; // Temporarily stores the next node
             currentBid->next = temp->next; // Moves the node after the next up one element
-            delete temp; // Deletes the orphan node.
+            if (tail == temp) {
+                tail = currentBid;
+            }
+            nodePool.destroy(temp); // Deletes the orphan node.
 
             --size;
             return;
@@ -207,8 +222,6 @@ void LinkedList::Remove(const string bidId) {
 Bid LinkedList::Search(const string bidId) {
     // Start at head node
     Node *currentBid = head;
-    Node* temp = new Node; // creates temporary, blank node
-    temp->bid.bidId = "";
 
     // Searches from head to tail
     while (currentBid != nullptr) {
@@ -217,7 +230,7 @@ Bid LinkedList::Search(const string bidId) {
         }
         currentBid = currentBid->next; // Iterates through the nodes
     }
-    return temp->bid; // Returns the blank node if bidID not found.
+    return Bid(); // Returns a blank bid if bidID not found.
 }
 
 /**
@@ -277,23 +290,33 @@ void loadBids(const string &csvPath, LinkedList* list) {
     cout << "Loading CSV file " << csvPath << endl;
 
     // initialize the CSV Parser
-    csv::Parser file = csv::Parser(csvPath);
+    csv::Reader file = csv::Reader(csvPath);
 
     try {
+        // Resolves each column by name once so rows are indexed without a lookup.
+        // The Dec 2016 extract names its columns differently from the monthly exports.
+        const csv::ColumnHandle titleColumn = file.column({"Auction Title", "ArticleTitle"});
+        const csv::ColumnHandle idColumn = file.column({"Auction ID", "ArticleID"});
+        const csv::ColumnHandle amountColumn = file.column({"Winning Bid", "WinningBid"});
+        const csv::ColumnHandle fundColumn = file.column("Fund");
+
+        // Only these columns are kept, the tokenizer skips the rest of each line
+        file.project({titleColumn.index, idColumn.index, amountColumn.index, fundColumn.index});
+
         // loop to read rows of a CSV file
-        for (int i = 0; i < file.rowCount(); i++) {
+        for (const csv::Row &row : file) {
 
-            // initialize a bid using data from current row (i)
+            // initialize a bid using data from the current row
             Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+            bid.bidId = row[idColumn];
+            bid.title = row[titleColumn];
+            bid.fund = row[fundColumn];
+            bid.amount = row.getCurrency(amountColumn);
 
             //cout << bid.bidId << ": " << bid.title << " | " << bid.fund << " | " << bid.amount << endl;
 
             // add this bid to the end
-            list->Append(bid);
+            list->Append(std::move(bid));
         }
     }
     catch (csv::Error& e) {
@@ -301,6 +324,55 @@ void loadBids(const string &csvPath, LinkedList* list) {
     }
 }
 
+/**
+ * Save every bid in the list to a binary snapshot file
+ *
+ * @param snapshotPath the path of the snapshot file to write
+ * @param list the list holding the bids
+ */
+void saveSnapshot(const string &snapshotPath, LinkedList* list) {
+    try {
+        snapshot::Writer writer;
+        list->ForEach([&writer](const Bid &bid) {
+            writer.add(bid.bidId, bid.title, bid.fund, bid.amount);
+        });
+        writer.save(snapshotPath);
+        cout << writer.size() << " bids saved to " << snapshotPath << endl;
+    } catch (snapshot::Error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+/**
+ * Load bids from a binary snapshot file instead of parsing the CSV file
+ *
+ * @param snapshotPath the path of the snapshot file to read
+ * @param list the list to add the bids to
+ */
+void loadSnapshot(const string &snapshotPath, LinkedList* list) {
+    cout << "Loading snapshot " << snapshotPath << endl;
+
+    try {
+        // Maps the file, the records are read straight out of the mapping
+        snapshot::Reader snap = snapshot::Reader(snapshotPath);
+
+        for (unsigned int i = 0; i < snap.size(); i++) {
+            Bid bid;
+            bid.bidId = string(snap.bidId(i));
+            bid.title = string(snap.title(i));
+            bid.fund = string(snap.fund(i));
+            bid.amount = snap.amount(i);
+
+            list->Append(std::move(bid));
+        }
+    } catch (snapshot::Error &e) {
+        std::cerr << e.what() << std::endl;
+    } catch (csv::Error &e) {
+        // Opening and mapping the file is shared with the CSV parser
+        std::cerr << e.what() << std::endl;
+    }
+}
+
 /**
  * Simple C function to convert a string to a double
  * after stripping out unwanted char
@@ -361,6 +433,7 @@ string processCommandLine(int argc, char* argv[]) {
  void mainMenu(const string &path) {
 
     const string &csvPath = path;
+    const string snapshotPath = csvPath + ".snap";
     string bidKey = {};
     clock_t ticks;
 
@@ -377,6 +450,8 @@ string processCommandLine(int argc, char* argv[]) {
         cout << "  4. Find Bid" << endl;
         cout << "  5. Remove Bid" << endl;
         cout << "  6. Prepend Bid" << endl;
+        cout << "  7. Save Snapshot" << endl;
+        cout << "  8. Load Snapshot" << endl;
         cout << "  9. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
@@ -436,6 +511,19 @@ string processCommandLine(int argc, char* argv[]) {
                 displayBid(bid);
                 break;
 
+            case 7:
+                saveSnapshot(snapshotPath, &bidList);
+                break;
+
+            case 8:
+                ticks = clock();
+
+                loadSnapshot(snapshotPath, &bidList);
+                cout << bidList.Size() << " bids read" << endl;
+
+                displayTelemetry(ticks);
+                break;
+
             default:
                 cout << "Goodbye." << endl;
                 break;
@@ -8,6 +8,9 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <functional>
+
+#include "HashMap.hpp"
 
 using namespace std;
 
@@ -22,6 +25,9 @@ struct Course {
     }
 };
 
+// Courses by course ID, for looking one up without walking the tree
+typedef table::HashTable<string, Course> CourseTable;
+
 // Internal structure holds a tree node.
 struct Node {
     Course course;
@@ -36,7 +42,7 @@ struct Node {
 
     // Use a course to initialize
     Node(Course someCourse) : Node() {
-        this->course = someCourse;
+        this->course = std::move(someCourse);
     }
 };
 
@@ -53,6 +59,7 @@ private:
     void inOrder(Node* node);
     void preOrder(Node* node);
     void ChopTree(Node* node);
+    void visitFrom(const string &low, const function<bool(const Course &)> &visit);
 
 public:
     BinarySearchTree();
@@ -61,6 +68,8 @@ public:
     void PreOrder();
     void Insert(Course course);
     Course Search(string courseID);
+    void RangeQuery(const string &low, const string &high, const function<void(const Course &)> &visit);
+    void PrefixQuery(const string &prefix, const function<void(const Course &)> &visit);
 };
 
 /**
@@ -72,15 +81,27 @@ BinarySearchTree::BinarySearchTree() {
 }
 
 /**
- * Recursively deletes tree nodes
+ * Deletes every node of a subtree. The nodes still to delete are kept
+ * on an explicit stack, so a tree of any depth is chopped without
+ * recursion.
  *
- * @param node Current node in tree
+ * @param node Root of the subtree
  */
 void BinarySearchTree::ChopTree(Node* node) {
-
+    vector<Node*> stack;
     if (node) {
-        ChopTree(node->left);
-        ChopTree(node->right);
+        stack.push_back(node);
+    }
+
+    while (!stack.empty()) {
+        node = stack.back();
+        stack.pop_back();
+        if (node->left) {
+            stack.push_back(node->left);
+        }
+        if (node->right) {
+            stack.push_back(node->right);
+        }
         delete node;
     }
 }
@@ -89,7 +110,7 @@ void BinarySearchTree::ChopTree(Node* node) {
  * Destructor
  */
 BinarySearchTree::~BinarySearchTree() {
-    // recurse from root deleting every node
+    // walk from root deleting every node
     ChopTree(root);
 
 }
@@ -159,34 +180,120 @@ Course BinarySearchTree::Search(string courseID) {
 }
 
 /**
- * Add a course to some node (recursive)
+ * Visits, in order, every course with an ID from low to high, both
+ * included, touching only the path down to low and the courses in
+ * the range.
+ *
+ * @param low - smallest course ID to visit
+ * @param high - largest course ID to visit
+ * @param visit - function called with each course in the range
+ */
+void BinarySearchTree::RangeQuery(const string &low, const string &high,
+                                  const function<void(const Course &)> &visit) {
+    this->visitFrom(low, [&high, &visit](const Course &course) {
+        if (course.courseID > high) {
+            return false;
+        }
+        visit(course);
+        return true;
+    });
+}
+
+/**
+ * Visits, in order, every course whose ID starts with the prefix,
+ * such as all the CSCI3 courses. They follow each other in order
+ * from the prefix itself, so the walk stops at the first that doesn't
+ * match.
+ *
+ * @param prefix - start of the course IDs to visit
+ * @param visit - function called with each matching course
+ */
+void BinarySearchTree::PrefixQuery(const string &prefix, const function<void(const Course &)> &visit) {
+    this->visitFrom(prefix, [&prefix, &visit](const Course &course) {
+        if (course.courseID.compare(0, prefix.size(), prefix) != 0) {
+            return false;
+        }
+        visit(course);
+        return true;
+    });
+}
+
+/**
+ * Walks the tree in order from the first course ID not below low
+ * until visit returns false. Left subtrees of nodes below low are
+ * skipped entirely.
+ *
+ * @param low - smallest course ID to visit
+ * @param visit - function called with each course, false to stop
+ */
+void BinarySearchTree::visitFrom(const string &low, const function<bool(const Course &)> &visit) {
+    vector<Node*> stack;
+    Node* node = root;
+    while (node != nullptr || !stack.empty()) {
+        while (node != nullptr) {
+            if (node->course.courseID < low) {
+                node = node->right;
+            } else {
+                stack.push_back(node);
+                node = node->left;
+            }
+        }
+        if (stack.empty()) {
+            return;
+        }
+        node = stack.back();
+        stack.pop_back();
+        if (!visit(node->course)) {
+            return;
+        }
+        node = node->right;
+    }
+}
+
+/**
+ * Add a course below some node, walking down in a loop
  *
  * @param node - Current node in tree
  * @param course - Course to be added
  */
 void BinarySearchTree::addNode(Node* node, Course course) {
-    // Node is larger than the course so add to left subtree.
-    if (node->course.courseID.compare(course.courseID) > 0) {
-        // Base case: If the left child does not exist, insert new code as left child
-        if (node->left == nullptr) {
-            node->left = new Node(course);
+    while (true) {
+        // Node is larger than the course so add to left subtree.
+        if (node->course.courseID.compare(course.courseID) > 0) {
+            // If the left child does not exist, insert new code as left child
+            if (node->left == nullptr) {
+                node->left = new Node(std::move(course));
+                return;
+            }
+            // If there is already a left child, keep looking from there
+            node = node->left;
         }
-            // If there is already a left child, recursively call addNode to find spot for new course
+            // Add to right subtree
         else {
-            this->addNode(node->left, course);
+            // If the right child does not exist, insert new node as right child
+            if (node->right == nullptr) {
+                node->right = new Node(std::move(course));
+                return;
+            }
+            // If it already has a right child, keep looking from there
+            node = node->right;
         }
     }
-        // Add to right subtree
-    else {
-        // Base case: If the right child does not exist, insert new node as right child
-        if (node->right == nullptr) {
-            node->right = new Node(course);
-        }
-            // If it already has a right child, recursively call addNode to find spot for new course
-        else {
-            this->addNode(node->right, course);
-        }
+}
+
+/**
+ * Prints one course and its prerequisites
+ *
+ * @param course - the course to print
+ */
+static void printCourse(const Course &course) {
+    cout << course.courseID << " - " << course.courseName << endl;
+    cout << "Prerequisites: ";
+    for (const auto& preReq : course.coursePrerequisites) {
+        cout << preReq << " ";
     }
+    cout << endl;
+    cout << "--------------------------------------------" << endl;
 }
 
 /**
@@ -196,30 +303,36 @@ void BinarySearchTree::addNode(Node* node, Course course) {
  * @param node - Current node in tree
  */
 void BinarySearchTree::inOrder(Node* node) {
-    if (node != nullptr) {
-        inOrder(node->left);
-        cout << node->course.courseID << " - " << node->course.courseName << endl;
-        cout << "Prerequisites: ";
-        for (const auto& preReq : node->course.coursePrerequisites) {
-            cout << preReq << " ";
+    // Left spine goes on the stack; each node popped is printed, then its right subtree walked
+    vector<Node*> stack;
+    while (node != nullptr || !stack.empty()) {
+        while (node != nullptr) {
+            stack.push_back(node);
+            node = node->left;
         }
-        cout << endl;
-        cout << "--------------------------------------------" << endl;
-        inOrder(node->right);
+        node = stack.back();
+        stack.pop_back();
+        printCourse(node->course);
+        node = node->right;
     }
 }
 
 void BinarySearchTree::preOrder(Node* node) {
+    // Right child is pushed under the left one so the left subtree comes first
+    vector<Node*> stack;
     if (node != nullptr) {
-        cout << node->course.courseID << " - " << node->course.courseName << endl;
-        cout << "Prerequisites: ";
-        for (const auto& preReq : node->course.coursePrerequisites) {
-            cout << preReq << " ";
+        stack.push_back(node);
+    }
+    while (!stack.empty()) {
+        node = stack.back();
+        stack.pop_back();
+        printCourse(node->course);
+        if (node->right != nullptr) {
+            stack.push_back(node->right);
+        }
+        if (node->left != nullptr) {
+            stack.push_back(node->left);
         }
-        cout << endl;
-        cout << "--------------------------------------------" << endl;
-        preOrder(node->left);
-        preOrder(node->right);
     }
 }
 
@@ -422,17 +535,22 @@ static vector<vector<string>> fileParser(const string& filePath) {
 }
 
 /**
- * Builds Course objects by parsing through each element within a string vector nested
- * inside of a parent vector.
+ * Loads the courses into the tree, which lists them in order, and
+ * moves them into the course table, which looks them up by ID.
  *
  * @param - courses - A vector of Course objects.
  * @param - tree - An empty binary search tree the courses will be attach to.
+ * @param - courseTable - An empty table the courses will be moved into.
  */
-static void loadCoursesIntoTree(vector<Course>& courses, BinarySearchTree* tree) {
+static void loadCourses(vector<Course>& courses, BinarySearchTree* tree, CourseTable* courseTable) {
     for (Course& course : courses) {
         tree->Insert(course);
+        courseTable->emplace(course.courseID, std::move(course));
     }
     courses.clear();
+
+    // Only lookups follow, which never move the buckets left from growing
+    courseTable->finishMigration();
 }
 
 /**
@@ -498,18 +616,17 @@ static void printSampleSchedule(BinarySearchTree* tree) {
 }
 
 /**
- * Searches the tree for a specific course number.
+ * Looks a specific course number up in the course table.
  *
- * @param - tree - the binary search tree storing course objects.
+ * @param - courseTable - the table storing course objects by course ID.
  * @param - courseNumber - string with the course ID being searched for.
  *
  */
-static void printCourseInformation(BinarySearchTree* tree, string courseNumber) {
-    Course course;
-    course = tree->Search(courseNumber);
+static void printCourseInformation(CourseTable* courseTable, const string &courseNumber) {
+    const Course* course = courseTable->find(courseNumber);
 
-    if (!course.courseID.empty()) {
-        displayCourse(course);
+    if (course != nullptr) {
+        displayCourse(*course);
     }
     else {
         cout << "Course " << courseNumber << " not found in catalog." << endl;
@@ -523,8 +640,9 @@ static void printCourseInformation(BinarySearchTree* tree, string courseNumber)
  * for a specific course. If the user enters 9, the program exits.
  *
  * @param - courseVector, a vector of Course object and tree, an empty Binary Search Tree
+ * @param - courseTable, an empty table for looking courses up by ID
  */
-static void mainMenu(vector <Course> &courseVector, BinarySearchTree* tree) {
+static void mainMenu(vector <Course> &courseVector, BinarySearchTree* tree, CourseTable* courseTable) {
     int userInput = {};
     string courseNumber = {};
 
@@ -538,6 +656,8 @@ static void mainMenu(vector <Course> &courseVector, BinarySearchTree* tree) {
         cout << "|-------------------------------|" << endl;
         cout << "|     3. Print Course           |" << endl;
         cout << "|-------------------------------|" << endl;
+        cout << "|     5. Print Courses by Prefix|" << endl;
+        cout << "|-------------------------------|" << endl;
         cout << "|     9. Exit                   |" << endl;
         cout << "|-------------------------------|" << endl;
         cout << "*********************************" << endl;
@@ -548,7 +668,7 @@ static void mainMenu(vector <Course> &courseVector, BinarySearchTree* tree) {
         switch (userInput) {
             case 1:
                 //sortVector(courses); FIXME adjust sort
-                loadCoursesIntoTree(courseVector, tree);
+                loadCourses(courseVector, tree, courseTable);
                 printCourseList(courseVector);
                 break;
 
@@ -562,7 +682,7 @@ static void mainMenu(vector <Course> &courseVector, BinarySearchTree* tree) {
                 cin>>courseNumber;
                 transform(courseNumber.begin(), courseNumber.end(), courseNumber.begin(), ::toupper);
                 cout << courseNumber << endl;
-                printCourseInformation(tree, courseNumber);
+                printCourseInformation(courseTable, courseNumber);
                 break;
             case 4:
                 sortVector(courseVector);
@@ -574,6 +694,14 @@ static void mainMenu(vector <Course> &courseVector, BinarySearchTree* tree) {
                 tree -> InOrder();
                 break;
 
+            case 5:
+                cout << "Which course numbers do you want to list? (e.g. CSCI3)" << endl;
+                cin.ignore();
+                cin>>courseNumber;
+                transform(courseNumber.begin(), courseNumber.end(), courseNumber.begin(), ::toupper);
+                tree->PrefixQuery(courseNumber, displayCourse);
+                break;
+
             case 9:
                 cout << "Thank you for using the course planner!" << endl;
                 break;
@@ -629,8 +757,9 @@ static void programDriver(const string& path) {
 
         BinarySearchTree* courseTree;
         courseTree = new BinarySearchTree();
+        CourseTable courseTable;
 
-        mainMenu(courses, courseTree);
+        mainMenu(courses, courseTree, &courseTable);
     }
     catch (const char* exp) { // Exception handling
         cout << "EXCEPTION: " << exp << endl;
@@ -87,17 +87,27 @@ vector<Bid> loadBids(string csvPath) {
     vector<Bid> bids;
 
     // Initializes the CSV Parser using the given path
-    csv::Parser file = csv::Parser(csvPath);
+    csv::Reader file = csv::Reader(csvPath);
 
     try {
+        // Resolves each column by name once so rows are indexed without a lookup.
+        // The Dec 2016 extract names its columns differently from the monthly exports.
+        const csv::ColumnHandle titleColumn = file.column({"Auction Title", "ArticleTitle"});
+        const csv::ColumnHandle idColumn = file.column({"Auction ID", "ArticleID"});
+        const csv::ColumnHandle amountColumn = file.column({"Winning Bid", "WinningBid"});
+        const csv::ColumnHandle fundColumn = file.column("Fund");
+
+        // Only these columns are kept, the tokenizer skips the rest of each line
+        file.project({titleColumn.index, idColumn.index, amountColumn.index, fundColumn.index});
+
         // Loop to read rows of a CSV file
-        for (int i = 0; i < file.rowCount(); i++) {
+        for (const csv::Row &row : file) {
             // Create a data structure and add to the collection of bids
             Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+            bid.bidId = row[idColumn];
+            bid.title = row[titleColumn];
+            bid.fund = row[fundColumn];
+            bid.amount = row.getCurrency(amountColumn);
             // push this bid to the end
             bids.push_back(bid);
         }